@@ -94,6 +94,8 @@ void AppDebugMessageHandler::messageHandler(QtMsgType type, const QMessageLogCon
   if (lvl < m_appDebugOutputLevel && type != QtFatalMsg)
     return;
 
+  QMutexLocker locker(&m_mutex);
+
 #if defined(Q_OS_LINUX) && (QT_VERSION < QT_VERSION_CHECK(5, 3, 0))
   // Filter out lots of QPainter warnings from undocked QDockWidgets... hackish but effective (only workaround found so far)
   if (lvl == 2 && QString(context.function).contains("QPainter::"))
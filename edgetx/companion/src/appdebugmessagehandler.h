@@ -28,6 +28,7 @@
 #include <QDebug>
 #include <QIODevice>
 #include <QMessageLogContext>
+#include <QMutex>
 #include <QObject>
 #include <QRegularExpression>
 #include <QString>
@@ -129,6 +130,7 @@ class AppDebugMessageHandler : public QObject
     QVector<QIODevice *> m_outputDevices;
     bool m_showSourcePath;
     bool m_showFunctionDeclarations;
+    QMutex m_mutex;  // messages may come from worker threads
 
   signals:
     void messageOutput(quint8 level, const QString & msg);
@@ -25,23 +25,35 @@
 #include "yaml_modeldata.h"
 
 #include <QMessageBox>
+#include <istream>
+#include <streambuf>
+
+// Read-only stream buffer over the bytes of a QByteArray (which may
+// be a memory mapped file), so that the parser reads them in place
+class ByteArrayStreamBuf : public std::streambuf
+{
+  public:
+    explicit ByteArrayStreamBuf(const QByteArray& data)
+    {
+      char* begin = const_cast<char*>(data.constData());
+      setg(begin, begin, begin + data.size());
+    }
+};
 
 static YAML::Node loadYamlFromByteArray(const QByteArray& data)
 {
-    // TODO: use real streaming to avoid memory copies
-    std::istringstream data_istream(data.toStdString());
+    ByteArrayStreamBuf data_buf(data);
+    std::istream data_istream(&data_buf);
     return YAML::Load(data_istream);
 }
 
 static void writeYamlToByteArray(const YAML::Node& node, QByteArray& data)
 {
-    // TODO: use real streaming to avoid memory copies
-    std::stringstream data_ostream;
-    data_ostream << node;
-    data = QByteArray::fromStdString(data_ostream.str());
+    YAML::Emitter emitter;
+    emitter << node;
+    data = QByteArray(emitter.c_str(), emitter.size());
 
-    qDebug() << "Saving YAML:";
-    qDebug() << data_ostream.str().c_str();
+    qDebug() << "Saving YAML, size:" << data.size();
 }
 
 bool loadModelsListFromYaml(std::vector<CategoryData>& categories,
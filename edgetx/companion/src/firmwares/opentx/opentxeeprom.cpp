@@ -26,6 +26,8 @@
 #include "customdebug.h"
 #include "opentxinterface.h"
 
+#include <QMutexLocker>
+
 using namespace Board;
 
 #define MAX_VIEWS(board)                      (HAS_LARGE_LCD(board) ? 2 : 256)
@@ -289,12 +291,15 @@ class SwitchesConversionTable: public ConversionTable {
         SwitchesConversionTable * table;
     };
 
+    // the models are decoded by several threads
     static std::list<Cache> internalCache;
+    static QMutex internalCacheMutex;
 
   public:
 
     static SwitchesConversionTable * getInstance(Board::Type board, unsigned int version, unsigned long flags=0)
     {
+      QMutexLocker locker(&internalCacheMutex);
       for (auto & element : internalCache) {
         if (element.board == board && element.version == version && element.flags == flags)
           return element.table;
@@ -306,6 +311,7 @@ class SwitchesConversionTable: public ConversionTable {
     }
     static void Cleanup()
     {
+      QMutexLocker locker(&internalCacheMutex);
       for (auto & element : internalCache) {
         delete element.table;
       }
@@ -314,6 +320,7 @@ class SwitchesConversionTable: public ConversionTable {
 };
 
 std::list<SwitchesConversionTable::Cache> SwitchesConversionTable::internalCache;
+QMutex SwitchesConversionTable::internalCacheMutex;
 
 #define FLAG_NONONE       0x01
 #define FLAG_NOSWITCHES   0x02
@@ -416,12 +423,15 @@ class SourcesConversionTable: public ConversionTable {
         unsigned long flags;
         SourcesConversionTable * table;
     };
+    // the models are decoded by several threads
     static std::list<Cache> internalCache;
+    static QMutex internalCacheMutex;
 
   public:
 
     static SourcesConversionTable * getInstance(Board::Type board, unsigned int version, unsigned int variant, unsigned long flags=0)
     {
+      QMutexLocker locker(&internalCacheMutex);
       for (std::list<Cache>::iterator it=internalCache.begin(); it!=internalCache.end(); it++) {
         Cache & element = *it;
         if (element.board == board && element.version == version && element.variant == variant && element.flags == flags)
@@ -434,6 +444,7 @@ class SourcesConversionTable: public ConversionTable {
     }
     static void Cleanup()
     {
+      QMutexLocker locker(&internalCacheMutex);
       for (std::list<Cache>::iterator it=internalCache.begin(); it!=internalCache.end(); it++) {
         Cache & element = *it;
         if (element.table)
@@ -444,6 +455,7 @@ class SourcesConversionTable: public ConversionTable {
 };
 
 std::list<SourcesConversionTable::Cache> SourcesConversionTable::internalCache;
+QMutex SourcesConversionTable::internalCacheMutex;
 
 void OpenTxEepromCleanup(void)
 {
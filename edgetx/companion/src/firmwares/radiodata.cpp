@@ -107,6 +107,10 @@ void RadioData::convert(RadioDataConversionState & cstate)
 
   // ensure proper number of model slots
   if (getCurrentFirmware()->getCapability(Models) && getCurrentFirmware()->getCapability(Models) != (int)models.size()) {
+    // the files of the models beyond the limit are not removed by the next save
+    for (unsigned i = getCurrentFirmware()->getCapability(Models); i < models.size(); i++) {
+      modelsDirectory.owned.remove(QString("MODELS/") + models[i].filename);
+    }
     models.resize(getCurrentFirmware()->getCapability(Models));
   }
 }
@@ -28,6 +28,17 @@ class RadioData {
     std::vector<CategoryData> categories;
     std::vector<ModelData> models;
 
+    // The MODELS directory of the last YAML load or save: the model files
+    // read or written there, which a save removes when they are not part
+    // of the data anymore, and the other ones the user chose to keep.
+    // Updated by the storage when the data is written.
+    struct ModelsDirectory {
+      QString path;
+      QSet<QString> owned;
+      QSet<QString> kept;
+    };
+    mutable ModelsDirectory modelsDirectory;
+
     void convert(RadioDataConversionState & cstate);
 
     void setCurrentModel(unsigned int index);
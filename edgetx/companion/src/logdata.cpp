@@ -0,0 +1,640 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "logdata.h"
+
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// below that size, a single thread scans the file
+#define LOG_MIN_CHUNK_SIZE    (256 * 1024)
+// each pyramid level groups 4 buckets of the level below
+#define LOG_PYRAMID_SHIFT     2
+
+struct LogChunk {
+  const char * begin;
+  const char * end;
+  int firstRow;
+  int rows;
+  int invalidLines;
+  int invalidTimes;
+};
+
+struct LogColumns {
+  int fields;
+  const char * data;
+  qint64 * offsets;
+  int * lengths;
+  double * times;
+  std::vector<double *> values;
+};
+
+// calls function(0) ... function(count - 1) from the given number of threads
+static void parallelFor(int count, int threads, const std::function<void(int)> & function)
+{
+  auto worker = [&](int first) {
+    for (int index = first; index < count; index += threads)
+      function(index);
+  };
+
+  std::vector<std::thread> workers;
+  for (int i = 1; i < threads && i < count; i++)
+    workers.emplace_back(worker, i);
+  worker(0);
+  for (auto & thread: workers)
+    thread.join();
+}
+
+static inline bool isSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+// same as QString::trimmed()
+static inline void trim(const char * & begin, const char * & end)
+{
+  while (begin < end && isSpace(*begin))
+    begin++;
+  while (end > begin && isSpace(end[-1]))
+    end--;
+}
+
+static inline const char * nextLine(const char * line, const char * end, const char * & eol)
+{
+  eol = (const char *)memchr(line, '\n', end - line);
+  if (!eol) {
+    eol = end;
+    return end;
+  }
+  return eol + 1;
+}
+
+static inline int fieldsCount(const char * begin, const char * end)
+{
+  int result = 1;
+  while ((begin = (const char *)memchr(begin, ',', end - begin))) {
+    result++;
+    begin++;
+  }
+  return result;
+}
+
+static inline bool parseDigits(const char * & s, const char * end, int count, int & value)
+{
+  value = 0;
+  for (int i = 0; i < count; i++, s++) {
+    if (s >= end || *s < '0' || *s > '9')
+      return false;
+    value = value * 10 + (*s - '0');
+  }
+  return true;
+}
+
+static inline bool parseChar(const char * & s, const char * end, char c)
+{
+  if (s >= end || *s != c)
+    return false;
+  s++;
+  return true;
+}
+
+// Same result as QString::toDouble() for the decimal numbers written by the
+// radio (0 when the cell isn't a number), but without the QString and
+// independent from the C locale
+static double parseNumber(const char * s, const char * end)
+{
+  static const double powers[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  trim(s, end);
+
+  bool negative = false;
+  if (s < end && (*s == '-' || *s == '+')) {
+    negative = (*s == '-');
+    s++;
+  }
+
+  quint64 mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool valid = false;
+
+  for (; s < end && *s >= '0' && *s <= '9'; s++) {
+    valid = true;
+    if (digits < 19) {
+      mantissa = mantissa * 10 + (*s - '0');
+      if (mantissa)
+        digits++;
+    }
+    else {
+      exponent++;
+    }
+  }
+
+  if (s < end && *s == '.') {
+    for (s++; s < end && *s >= '0' && *s <= '9'; s++) {
+      valid = true;
+      if (digits < 19) {
+        mantissa = mantissa * 10 + (*s - '0');
+        if (mantissa)
+          digits++;
+        exponent--;
+      }
+    }
+  }
+
+  if (!valid)
+    return 0;
+
+  if (s < end && (*s == 'e' || *s == 'E')) {
+    s++;
+    bool negativeExponent = false;
+    if (s < end && (*s == '-' || *s == '+')) {
+      negativeExponent = (*s == '-');
+      s++;
+    }
+    if (s >= end)
+      return 0;
+    int value = 0;
+    for (; s < end && *s >= '0' && *s <= '9'; s++) {
+      if (value < 10000)
+        value = value * 10 + (*s - '0');
+    }
+    exponent += negativeExponent ? -value : value;
+  }
+
+  if (s != end)
+    return 0;
+
+  double result = mantissa;
+  if (exponent < 0 && exponent >= -22)
+    result /= powers[-exponent];
+  else if (exponent > 0 && exponent <= 22)
+    result *= powers[exponent];
+  else if (exponent != 0)
+    result *= std::pow(10.0, exponent);
+
+  return negative ? -result : result;
+}
+
+class LogTimeParser
+{
+  public:
+    // "yyyy-MM-dd", "HH:mm:ss[.zzz]"
+    double parse(const char * date, const char * dateEnd, const char * time, const char * timeEnd)
+    {
+      int year, month, day, hour, minute, second;
+
+      if (!parseDigits(date, dateEnd, 4, year) || !parseChar(date, dateEnd, '-') ||
+          !parseDigits(date, dateEnd, 2, month) || !parseChar(date, dateEnd, '-') ||
+          !parseDigits(date, dateEnd, 2, day) || date != dateEnd)
+        return NAN;
+
+      if (!parseDigits(time, timeEnd, 2, hour) || !parseChar(time, timeEnd, ':') ||
+          !parseDigits(time, timeEnd, 2, minute) || !parseChar(time, timeEnd, ':') ||
+          !parseDigits(time, timeEnd, 2, second) || minute > 59 || second > 59)
+        return NAN;
+
+      double fraction = 0;
+      if (time < timeEnd) {
+        if (*time != '.')
+          return NAN;
+        fraction = parseNumber(time, timeEnd);
+      }
+
+      // the local time conversion is only done once per hour of log
+      int key = ((year * 16 + month) * 32 + day) * 32 + hour;
+      if (key != lastKey) {
+        QDateTime dateTime(QDate(year, month, day), QTime(hour, 0));
+        if (!dateTime.isValid())
+          return NAN;
+        lastKey = key;
+        lastHour = dateTime.toTime_t();
+      }
+
+      return lastHour + minute * 60 + second + fraction;
+    }
+
+  protected:
+    int lastKey = -1;
+    double lastHour = 0;
+};
+
+static void countChunk(LogChunk & chunk, int fields)
+{
+  const char * eol;
+  for (const char * line = chunk.begin; line < chunk.end; ) {
+    const char * next = nextLine(line, chunk.end, eol);
+    trim(line, eol);
+    if (fieldsCount(line, eol) == fields)
+      chunk.rows++;
+    else
+      chunk.invalidLines++;
+    line = next;
+  }
+}
+
+static void parseChunk(LogChunk & chunk, const LogColumns & columns)
+{
+  LogTimeParser timeParser;
+  const char * fields[4];
+  int row = chunk.firstRow;
+
+  const char * eol;
+  for (const char * line = chunk.begin; line < chunk.end; ) {
+    const char * next = nextLine(line, chunk.end, eol);
+    trim(line, eol);
+    if (fieldsCount(line, eol) == columns.fields) {
+      columns.offsets[row] = line - columns.data;
+      columns.lengths[row] = eol - line;
+
+      const char * field = line;
+      for (int column = 0; column < columns.fields; column++) {
+        const char * end = (const char *)memchr(field, ',', eol - field);
+        if (!end)
+          end = eol;
+        if (column < 2) {
+          fields[column * 2] = field;
+          fields[column * 2 + 1] = end;
+        }
+        else {
+          columns.values[column][row] = parseNumber(field, end);
+        }
+        field = end + 1;
+      }
+
+      double time = timeParser.parse(fields[0], fields[1], fields[2], fields[3]);
+      if (std::isnan(time))
+        chunk.invalidTimes++;
+      columns.times[row++] = time;
+    }
+    line = next;
+  }
+}
+
+LogData::LogData():
+  data(nullptr),
+  size(0),
+  headerLength(0),
+  rows(0),
+  invalidLines(0),
+  invalidTimes(0),
+  sortedTimes(false)
+{
+}
+
+LogData::~LogData()
+{
+  clear();
+}
+
+void LogData::clear()
+{
+  if (file.isOpen()) {
+    if (data && buffer.isEmpty())
+      file.unmap((uchar *)data);
+    file.close();
+  }
+  buffer.clear();
+  data = nullptr;
+  size = 0;
+  headerLength = 0;
+  rows = 0;
+  invalidLines = 0;
+  invalidTimes = 0;
+  header.clear();
+  lineOffsets.clear();
+  lineLengths.clear();
+  times.clear();
+  columns.clear();
+  pyramids.clear();
+  sortedTimes = false;
+}
+
+bool LogData::load(const QString & filename)
+{
+  clear();
+
+  file.setFileName(filename);
+  if (!file.open(QIODevice::ReadOnly))
+    return false;
+
+  size = file.size();
+  data = (const char *)file.map(0, size);
+  if (!data) {
+    // not a regular file, or no address space left
+    buffer = file.readAll();
+    data = buffer.constData();
+    size = buffer.size();
+  }
+
+  if (!scan()) {
+    clear();
+    return false;
+  }
+
+  return true;
+}
+
+bool LogData::scan()
+{
+  const char * end = data + size;
+
+  if (size < 9 || memcmp(data, "Date,Time", 9))
+    return false;
+
+  const char * eol;
+  const char * body = nextLine(data, end, eol);
+  const char * headerEnd = eol;
+  const char * headerBegin = data;
+  trim(headerBegin, headerEnd);
+  headerLength = headerEnd - headerBegin;
+  header = QString::fromUtf8(headerBegin, headerLength).split(',');
+  int fields = header.count();
+
+  int threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = std::min<qint64>(threads, (end - body) / LOG_MIN_CHUNK_SIZE + 1);
+
+  // chunks start on a line boundary
+  std::vector<LogChunk> chunks(threads);
+  for (int i = 0; i < threads; i++) {
+    LogChunk & chunk = chunks[i];
+    memset(&chunk, 0, sizeof(chunk));
+    if (i == 0) {
+      chunk.begin = body;
+    }
+    else {
+      chunk.begin = body + (end - body) * i / threads;
+      if (chunk.begin[-1] != '\n')
+        chunk.begin = nextLine(chunk.begin, end, eol);
+      chunks[i - 1].end = chunk.begin;
+    }
+  }
+  chunks[threads - 1].end = end;
+
+  // first pass: the number of rows of each chunk, so that the second one
+  // can fill the columns in place
+  parallelFor(threads, threads, [&](int i) { countChunk(chunks[i], fields); });
+
+  for (auto & chunk: chunks) {
+    chunk.firstRow = rows;
+    rows += chunk.rows;
+    invalidLines += chunk.invalidLines;
+  }
+
+  if (rows == 0)
+    return false;
+
+  lineOffsets.resize(rows);
+  lineLengths.resize(rows);
+  times.resize(rows);
+  columns.resize(fields);
+
+  LogColumns target;
+  target.fields = fields;
+  target.data = data;
+  target.offsets = lineOffsets.data();
+  target.lengths = lineLengths.data();
+  target.times = times.data();
+  target.values.resize(fields, nullptr);
+  for (int column = 2; column < fields; column++) {
+    columns[column].resize(rows);
+    target.values[column] = columns[column].data();
+  }
+
+  parallelFor(threads, threads, [&](int i) { parseChunk(chunks[i], target); });
+
+  for (auto & chunk: chunks) {
+    invalidTimes += chunk.invalidTimes;
+  }
+
+  sortedTimes = (invalidTimes == 0);
+  for (int row = 1; sortedTimes && row < rows; row++) {
+    if (times[row] < times[row - 1])
+      sortedTimes = false;
+  }
+
+  pyramids.resize(fields);
+  threads = std::max(1u, std::thread::hardware_concurrency());
+  parallelFor(fields - 2, threads, [&](int i) { buildPyramid(i + 2); });
+
+  return true;
+}
+
+void LogData::buildPyramid(int column)
+{
+  const double * values = columns[column].constData();
+  QVector<PyramidLevel> & levels = pyramids[column];
+
+  int count = rows;
+  for (int level = 0; count > 1; level++) {
+    int buckets = (count + (1 << LOG_PYRAMID_SHIFT) - 1) >> LOG_PYRAMID_SHIFT;
+    levels.resize(level + 1);
+    PyramidLevel & current = levels[level];
+    current.minRows.resize(buckets);
+    current.maxRows.resize(buckets);
+
+    for (int bucket = 0; bucket < buckets; bucket++) {
+      int first = bucket << LOG_PYRAMID_SHIFT;
+      int last = std::min(first + (1 << LOG_PYRAMID_SHIFT), count);
+      int minRow = 0, maxRow = 0;
+      for (int i = first; i < last; i++) {
+        int lowRow = (level == 0) ? i : levels[level - 1].minRows[i];
+        int highRow = (level == 0) ? i : levels[level - 1].maxRows[i];
+        if (i == first || values[lowRow] < values[minRow])
+          minRow = lowRow;
+        if (i == first || values[highRow] > values[maxRow])
+          maxRow = highRow;
+      }
+      current.minRows[bucket] = minRow;
+      current.maxRows[bucket] = maxRow;
+    }
+
+    count = buckets;
+  }
+}
+
+int LogData::rowAt(double time) const
+{
+  return std::lower_bound(times.constBegin(), times.constEnd(), time) - times.constBegin();
+}
+
+void LogData::getRangeRows(int column, int first, int last, int & minRow, int & maxRow) const
+{
+  const double * values = columns[column].constData();
+  const QVector<PyramidLevel> & levels = pyramids[column];
+
+  minRow = maxRow = first;
+
+  // the biggest aligned buckets which fit in the range
+  for (int row = first; row < last; ) {
+    int level = -1;
+    while (level + 1 < levels.count()) {
+      int size = 1 << ((level + 2) * LOG_PYRAMID_SHIFT);
+      if ((row & (size - 1)) || row + size > last)
+        break;
+      level++;
+    }
+
+    int lowRow = row, highRow = row;
+    if (level >= 0) {
+      int bucket = row >> ((level + 1) * LOG_PYRAMID_SHIFT);
+      lowRow = levels[level].minRows[bucket];
+      highRow = levels[level].maxRows[bucket];
+      row += 1 << ((level + 1) * LOG_PYRAMID_SHIFT);
+    }
+    else {
+      row++;
+    }
+
+    if (values[lowRow] < values[minRow])
+      minRow = lowRow;
+    if (values[highRow] > values[maxRow])
+      maxRow = highRow;
+  }
+}
+
+void LogData::getRange(int column, int first, int last, double & min, double & max) const
+{
+  int minRow, maxRow;
+  getRangeRows(column, first, last, minRow, maxRow);
+  min = columns[column][minRow];
+  max = columns[column][maxRow];
+}
+
+void LogData::decimate(int column, int first, int last, int buckets, QVector<double> & x, QVector<double> & y) const
+{
+  const QVector<double> & values = columns[column];
+
+  x.clear();
+  y.clear();
+
+  if (last - first <= 4 * buckets || !sortedTimes) {
+    x.reserve(last - first);
+    y.reserve(last - first);
+    for (int row = first; row < last; row++) {
+      x.append(times[row]);
+      y.append(values[row]);
+    }
+    return;
+  }
+
+  x.reserve(4 * buckets);
+  y.reserve(4 * buckets);
+
+  double start = times[first];
+  double duration = times[last - 1] - start;
+
+  for (int bucket = 0, bucketFirst = first; bucket < buckets && bucketFirst < last; bucket++) {
+    int bucketLast = (bucket == buckets - 1) ? last :
+      std::max(bucketFirst + 1, rowAt(start + duration * (bucket + 1) / buckets));
+    bucketLast = std::min(bucketLast, last);
+
+    int points[4] = { bucketFirst, 0, 0, bucketLast - 1 };
+    getRangeRows(column, bucketFirst, bucketLast, points[1], points[2]);
+    if (points[1] > points[2])
+      std::swap(points[1], points[2]);
+
+    for (int i = 0; i < 4; i++) {
+      if (i == 0 || points[i] != points[i - 1]) {
+        x.append(times[points[i]]);
+        y.append(values[points[i]]);
+      }
+    }
+
+    bucketFirst = bucketLast;
+  }
+}
+
+QByteArray LogData::headerLine() const
+{
+  return QByteArray(data, headerLength);
+}
+
+QByteArray LogData::line(int row) const
+{
+  return QByteArray(data + lineOffsets.at(row), lineLengths.at(row));
+}
+
+QString LogData::text(int row, int column) const
+{
+  const char * field = data + lineOffsets.at(row);
+  const char * eol = field + lineLengths.at(row);
+
+  for (; column > 0; column--) {
+    field = (const char *)memchr(field, ',', eol - field);
+    if (!field)
+      return QString();
+    field++;
+  }
+
+  const char * end = (const char *)memchr(field, ',', eol - field);
+  return QString::fromUtf8(field, (end ? end : eol) - field);
+}
+
+LogTableModel::LogTableModel(QObject * parent):
+  QAbstractTableModel(parent),
+  logData(nullptr)
+{
+}
+
+void LogTableModel::setLogData(const LogData * logData)
+{
+  beginResetModel();
+  this->logData = logData;
+  endResetModel();
+}
+
+int LogTableModel::rowCount(const QModelIndex & parent) const
+{
+  return (logData && !parent.isValid()) ? logData->rowCount() : 0;
+}
+
+int LogTableModel::columnCount(const QModelIndex & parent) const
+{
+  return (logData && !parent.isValid()) ? logData->columnCount() : 0;
+}
+
+QVariant LogTableModel::data(const QModelIndex & index, int role) const
+{
+  if (!logData || !index.isValid() || role != Qt::DisplayRole)
+    return QVariant();
+
+  return logData->text(index.row(), index.column());
+}
+
+QVariant LogTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (!logData || role != Qt::DisplayRole)
+    return QVariant();
+
+  if (orientation == Qt::Horizontal)
+    return logData->headerLabels().value(section);
+
+  return section + 1;
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#pragma once
+
+#include <QtCore>
+
+// Telemetry log (CSV) loaded as typed columns.
+//
+// The file is memory mapped and scanned once by several threads: every
+// numeric cell is converted to a double (0 when not a number, as
+// QString::toDouble() did) and the Date/Time columns to a timestamp. The
+// text of a cell is only extracted from the mapped file when asked for,
+// so nothing else is kept per cell.
+//
+// Each numeric column also gets a min/max pyramid (the rows of the lowest
+// and highest values of every 4, 16, 64... rows), so that the extremes of
+// any range of rows are found in O(log n) and a plot of millions of rows
+// is reduced to the few points visible on each pixel (M4 decimation).
+
+class LogData
+{
+  public:
+    LogData();
+    ~LogData();
+
+    bool load(const QString & filename);
+    void clear();
+
+    bool isEmpty() const { return rows == 0; }
+    int rowCount() const { return rows; }
+    int columnCount() const { return header.count(); }
+    // lines with the wrong number of fields, which are skipped
+    int invalidLinesCount() const { return invalidLines; }
+    int linesCount() const { return rows + invalidLines; }
+
+    const QStringList & headerLabels() const { return header; }
+    QString text(int row, int column) const;
+    QByteArray line(int row) const;
+    QByteArray headerLine() const;
+
+    // the values of the column (empty for Date and Time)
+    const QVector<double> & values(int column) const { return columns.at(column); }
+
+    // seconds since the epoch (local time), NaN when the Date/Time are invalid
+    const QVector<double> & timestamps() const { return times; }
+    double timestamp(int row) const { return times.at(row); }
+    bool hasInvalidTimestamps() const { return invalidTimes > 0; }
+    // all valid and in chronological order, which decimation relies on
+    bool hasSortedTimestamps() const { return sortedTimes; }
+    // the first row at or after time (needs sorted timestamps)
+    int rowAt(double time) const;
+
+    // lowest and highest values of the rows [first, last)
+    void getRange(int column, int first, int last, double & min, double & max) const;
+    // the rows [first, last) reduced to the first, last, lowest and highest
+    // samples of each of the (time based) buckets, enough for a plot that
+    // is buckets pixels wide to look the same as with all the samples
+    void decimate(int column, int first, int last, int buckets, QVector<double> & x, QVector<double> & y) const;
+
+  protected:
+    // the rows of the extremes of each group of 4^(level+1) rows
+    struct PyramidLevel {
+      QVector<int> minRows;
+      QVector<int> maxRows;
+    };
+
+    bool scan();
+    void buildPyramid(int column);
+    void getRangeRows(int column, int first, int last, int & minRow, int & maxRow) const;
+
+    QFile file;
+    QByteArray buffer;
+    const char * data;
+    qint64 size;
+    int headerLength;
+
+    int rows;
+    int invalidLines;
+    int invalidTimes;
+    QStringList header;
+    QVector<qint64> lineOffsets;
+    QVector<int> lineLengths;
+    QVector<double> times;
+    QVector<QVector<double>> columns;
+    QVector<QVector<PyramidLevel>> pyramids;
+    bool sortedTimes;
+};
+
+class LogTableModel : public QAbstractTableModel
+{
+  Q_OBJECT
+
+  public:
+    explicit LogTableModel(QObject * parent = nullptr);
+
+    void setLogData(const LogData * logData);
+
+    int rowCount(const QModelIndex & parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex & parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+  protected:
+    const LogData * logData;
+};
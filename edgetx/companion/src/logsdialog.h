@@ -24,6 +24,7 @@
 #include <QtCore>
 #include <QDialog>
 #include "qcustomplot.h"
+#include "logdata.h"
 
 #define INVALID_MIN 999999
 #define INVALID_MAX -999999
@@ -50,6 +51,14 @@ class LogsDialog : public QDialog
     double max_y;
     yaxes_t yaxis;
     QString name;
+    int column;
+  };
+
+  // plotted column of a graph, and the scaling of its values
+  struct plotSource_t {
+    int column;
+    double offset;
+    double factor;
   };
 
   struct minMax_t {
@@ -82,9 +91,11 @@ private slots:
   void on_sessions_CB_currentIndexChanged(int index);
   void on_mapsButton_clicked();
   void yAxisChangeRanges(QCPRange range);
+  void xAxisChangeRange(QCPRange range);
 
 private:
-  QList<QStringList> csvlog;
+  LogData logData;
+  LogTableModel * logModel;
   Ui::LogsDialog *ui;
   QCPAxisRect *axisRect;
   QCPLegend *rightLegend;
@@ -102,10 +113,16 @@ private:
   QCPItemTracer * cursorB;
   QCPItemStraightLine * cursorLine;
 
+  // graphs decimated from the rows [lodFirstRow, lodLastRow), -1 when
+  // they hold every sample
+  QVector<plotSource_t> plotSources;
+  int lodFirstRow;
+  int lodLastRow;
+
   bool cvsFileParse();
-  QList<QStringList> filterGePoints(const QList<QStringList> & input);
+  QVector<int> filterGePoints();
   void exportToGoogleEarth();
-  QDateTime getRecordTimeStamp(int index);
+  QDateTime getRecordTimeStamp(int row);
   QString generateDuration(const QDateTime & start, const QDateTime & end);
   void setFlightSessions();
 
@@ -116,6 +133,7 @@ private:
   void placeCursor(double x, bool second);
   QString formatTimeDelta(double timeDelta);
   void updateCursorsLabel();
+  int plotWidth();
 
 
 };
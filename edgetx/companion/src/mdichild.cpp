@@ -36,6 +36,7 @@
 
 #include <algorithm>
 #include <ExportableTableView>
+#include <QProgressDialog>
 
 MdiChild::MdiChild(QWidget * parent, QWidget * parentWin, Qt::WindowFlags f):
   QWidget(parent, f),
@@ -1341,8 +1342,21 @@ void MdiChild::newFile(bool createDefaults)
 bool MdiChild::loadFile(const QString & filename, bool resetCurrentFile)
 {
   Storage storage(filename);
+
+  // only shown when loading the models takes a while
+  QProgressDialog progress(tr("Loading models..."), tr("Cancel"), 0, 0, this);
+  progress.setWindowModality(Qt::WindowModal);
+  progress.setMinimumDuration(500);
+  storage.setProgressHandler([&progress](int done, int total) {
+    progress.setMaximum(total);
+    // a modal dialog processes the events itself
+    progress.setValue(done);
+    return !progress.wasCanceled();
+  });
+
   if (!storage.load(radioData)) {
-    QMessageBox::critical(this, CPN_STR_TTL_ERROR, storage.error());
+    if (!progress.wasCanceled())
+      QMessageBox::critical(this, CPN_STR_TTL_ERROR, storage.error());
     return false;
   }
 
@@ -1401,6 +1415,11 @@ bool MdiChild::saveFile(const QString & filename, bool setCurrent)
 {
   radioData.fixModelFilenames();
   Storage storage(filename);
+  storage.setRemoveHandler([this](const QStringList & files) {
+    return askQuestion(tr("These model files are not part of the saved models:\n%1\n"
+                          "Do you want to delete them? Otherwise the radio may still list them.")
+                       .arg(files.join("\n"))) == QMessageBox::Yes;
+  });
   bool result = storage.write(radioData);
   if (!result) {
     return false;
@@ -23,8 +23,83 @@
 #include "firmwares/edgetx/edgetxinterface.h"
 #include "miniz.c"    //  Can only be included once!
 
+#include <QThreadPool>
+#include <atomic>
 #include <regex>
 
+#define PROGRESS_INTERVAL_MS    100
+
+class ModelsDecoder : public QRunnable
+{
+  public:
+    explicit ModelsDecoder(const std::function<void()> & function):
+      function(function)
+    {
+    }
+
+    virtual void run()
+    {
+      function();
+    }
+
+  protected:
+    std::function<void()> function;
+};
+
+// The model files are extracted before, and the models finalized after,
+// in order by the caller: only the decoding, which touches nothing else
+// than its own ModelData, runs in the pool. Meanwhile the calling thread
+// reports the progress and may cancel the remaining models.
+bool CategorizedStorageFormat::decodeModels(int count, const std::function<QString(int index)> & decode)
+{
+  std::vector<QString> errors(count);
+  std::atomic<int> next(0);
+  std::atomic<int> done(0);
+  std::atomic<bool> stop(false);
+  bool cancelled = false;
+
+  auto worker = [&]() {
+    int index;
+    while (!stop && (index = next++) < count) {
+      errors[index] = decode(index);
+      if (!errors[index].isEmpty())
+        stop = true;
+      done++;
+    }
+  };
+
+  QThreadPool pool;
+  int threads = std::min(pool.maxThreadCount(), count);
+  for (int i = 0; i < threads; i++) {
+    pool.start(new ModelsDecoder(worker));
+  }
+
+  while (!pool.waitForDone(PROGRESS_INTERVAL_MS)) {
+    if (progressHandler && !cancelled && !progressHandler(done, count)) {
+      cancelled = true;
+      stop = true;
+    }
+  }
+
+  if (cancelled) {
+    setError(tr("Loading cancelled"));
+    return false;
+  }
+
+  for (const auto & error: errors) {
+    if (!error.isEmpty()) {
+      setError(error);
+      return false;
+    }
+  }
+
+  if (progressHandler) {
+    progressHandler(count, count);
+  }
+
+  return true;
+}
+
 bool CategorizedStorageFormat::load(RadioData & radioData)
 {
   StorageType st = getStorageType(filename);
@@ -81,6 +156,14 @@ bool CategorizedStorageFormat::loadBin(RadioData & radioData)
     return false;
   }
 
+  struct ModelFile {
+    QString fileName;
+    int modelIndex;
+    int categoryIndex;
+    QByteArray buffer;
+  };
+  std::vector<ModelFile> modelFiles;
+
   QList<QByteArray> lines = modelsListBuffer.split('\n');
   int modelIndex = 0;
   int categoryIndex = -1;
@@ -116,7 +199,7 @@ bool CategorizedStorageFormat::loadBin(RadioData & radioData)
       parts.removeFirst();
     }
     if (parts.size() == 1) {
-      // parse model file name and load
+      // parse model file name and extract it, the models are decoded below
       QString fileName = parts[0];
       qDebug() << "Loading model from file" << fileName << "into slot" << modelIndex;
       QByteArray modelBuffer;
@@ -127,19 +210,7 @@ bool CategorizedStorageFormat::loadBin(RadioData & radioData)
       if ((int)radioData.models.size() <= modelIndex) {
         radioData.models.resize(modelIndex + 1);
       }
-      if (!loadModelFromByteArray(radioData.models[modelIndex], modelBuffer)) {
-        setError(tr("Error loading models"));
-        return false;
-      }
-      strncpy(radioData.models[modelIndex].filename, qPrintable(fileName), sizeof(radioData.models[modelIndex].filename));
-      if (IS_FAMILY_HORUS_OR_T16(board) && !strcmp(radioData.generalSettings.currModelFilename, qPrintable(fileName))) {
-        radioData.generalSettings.currModelIndex = modelIndex;
-        qDebug() << "currModelIndex =" << modelIndex;
-      }
-      if (getCurrentFirmware()->getCapability(HasModelCategories)) {
-        radioData.models[modelIndex].category = categoryIndex;
-      }
-      radioData.models[modelIndex].used = true;
+      modelFiles.push_back({ fileName, modelIndex, categoryIndex, modelBuffer });
       modelIndex++;
       continue;
     }
@@ -149,6 +220,32 @@ bool CategorizedStorageFormat::loadBin(RadioData & radioData)
     qDebug() << "Invalid line" <<line;
     continue;
   }
+
+  bool decoded = decodeModels(modelFiles.size(), [&](int index) -> QString {
+    ModelFile & modelFile = modelFiles[index];
+    if (!loadModelFromByteArray(radioData.models[modelFile.modelIndex], modelFile.buffer)) {
+      return tr("Error loading models");
+    }
+    modelFile.buffer.clear();
+    return QString();
+  });
+  if (!decoded) {
+    return false;
+  }
+
+  for (const auto & modelFile: modelFiles) {
+    ModelData & model = radioData.models[modelFile.modelIndex];
+    strncpy(model.filename, qPrintable(modelFile.fileName), sizeof(model.filename));
+    if (IS_FAMILY_HORUS_OR_T16(board) && !strcmp(radioData.generalSettings.currModelFilename, qPrintable(modelFile.fileName))) {
+      radioData.generalSettings.currModelIndex = modelFile.modelIndex;
+      qDebug() << "currModelIndex =" << modelFile.modelIndex;
+    }
+    if (getCurrentFirmware()->getCapability(HasModelCategories)) {
+      model.category = modelFile.categoryIndex;
+    }
+    model.used = true;
+  }
+
   return true;
 }
 
@@ -306,7 +403,9 @@ bool CategorizedStorageFormat::loadYaml(RadioData & radioData)
   int modelIdx = 0;
   bool hasCategories = getCurrentFirmware()->getCapability(HasModelCategories);
 
-  radioData.models.resize(modelFiles.size());
+  // extract the model files in order, the models are decoded in parallel
+  std::vector<QByteArray> modelBuffers;
+  std::vector<QString> modelFilenames;
   for (const auto& mc : modelFiles) {
     qDebug() << "Filename: " << mc.filename.c_str() << " / Category: " << mc.category;
 
@@ -317,20 +416,32 @@ bool CategorizedStorageFormat::loadYaml(RadioData & radioData)
       return false;
     }
 
-    // Please note:
-    //  ModelData() use memset to clear everything to 0
-    //
-    auto& model = radioData.models[modelIdx];
+    modelBuffers.push_back(modelBuffer);
+    modelFilenames.push_back(filename);
+  }
 
+  // Please note:
+  //  ModelData() use memset to clear everything to 0
+  //
+  radioData.models.resize(modelFiles.size());
+
+  bool decoded = decodeModels(modelFiles.size(), [&](int index) -> QString {
     try {
-      if (!loadModelFromYaml(model,modelBuffer)) {
-        setError(tr("Can't load ") + filename);
-        return false;
+      if (!loadModelFromYaml(radioData.models[index], modelBuffers[index])) {
+        return tr("Can't load ") + modelFilenames[index];
       }
     } catch(const std::runtime_error& e) {
-      setError(tr("Can't load ") + filename + ":\n" + QString(e.what()));
-      return false;
+      return tr("Can't load ") + modelFilenames[index] + ":\n" + QString(e.what());
     }
+    modelBuffers[index].clear();
+    return QString();
+  });
+  if (!decoded) {
+    return false;
+  }
+
+  for (const auto& mc : modelFiles) {
+    auto& model = radioData.models[modelIdx];
 
     model.category = mc.category;
     model.modelIndex = modelIdx;
@@ -24,6 +24,7 @@
 #include "storage.h"
 
 #include <QtCore>
+#include <functional>
 #include <list>
 #include <string>
 
@@ -50,6 +51,9 @@ class CategorizedStorageFormat : public StorageFormat
     virtual bool loadYaml(RadioData & radioData);
     virtual bool writeYaml(const RadioData & radioData);
 
+    // decode(index) returns an error message, or an empty string
+    bool decodeModels(int count, const std::function<QString(int index)> & decode);
+
     StorageType probeFormat();
 };
 
@@ -32,13 +32,22 @@ bool EtxFormat::load(RadioData & radioData)
     return false;
   }
 
-  QByteArray archiveContents = file.readAll();
+  // the archive is mapped rather than read, only the files extracted from
+  // it are copied
+  QByteArray archiveContents;
+  const char * archiveData = (const char *)file.map(0, file.size());
+  qint64 archiveSize = file.size();
+  if (!archiveData) {
+    archiveContents = file.readAll();
+    archiveData = archiveContents.constData();
+    archiveSize = archiveContents.size();
+  }
 
-  qDebug() << "File" << filename << "read, size:" << archiveContents.size();
+  qDebug() << "File" << filename << "read, size:" << archiveSize;
 
   // open zip file
   memset(&zip_archive, 0, sizeof(zip_archive));
-  if (!mz_zip_reader_init_mem(&zip_archive, archiveContents.data(), archiveContents.size(), 0)) {
+  if (!mz_zip_reader_init_mem(&zip_archive, archiveData, archiveSize, 0)) {
     qDebug() << tr("Error opening EdgeTX archive %1").arg(filename);
     return false;
   }
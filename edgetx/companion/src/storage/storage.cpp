@@ -90,6 +90,7 @@ bool Storage::load(RadioData & radioData)
   foreach(StorageFactory * factory, registeredStorageFactories) {
     if (factory->probe(filename)) {
       StorageFormat * format = factory->instance(filename);
+      format->setProgressHandler(progressHandler);
       if (format->load(radioData)) {
         board = format->getBoard();
         setWarning(format->warning());
@@ -113,6 +114,7 @@ bool Storage::write(const RadioData & radioData)
   foreach(StorageFactory * factory, registeredStorageFactories) {
     if (factory->probe(filename)) {
       StorageFormat * format = factory->instance(filename);
+      format->setRemoveHandler(removeHandler);
       ret = format->write(radioData);
       delete format;
       break;
@@ -26,6 +26,7 @@
 #include <QtCore>
 #include <QString>
 #include <QDebug>
+#include <functional>
 
 enum StorageType
 {
@@ -48,6 +49,14 @@ class StorageFormat
   Q_DECLARE_TR_FUNCTIONS(StorageFormat)
 
   public:
+    // Called from the loading thread with the number of models loaded so
+    // far, returning false cancels the load
+    typedef std::function<bool(int done, int total)> ProgressHandler;
+
+    // Called with the files a save would remove although they were not
+    // loaded from there, returning false keeps them
+    typedef std::function<bool(const QStringList & files)> RemoveHandler;
+
     StorageFormat(const QString & filename, uint8_t version=0):
       filename(filename),
       version(version),
@@ -73,6 +82,16 @@ class StorageFormat
       return board;
     }
 
+    void setProgressHandler(const ProgressHandler & handler)
+    {
+      progressHandler = handler;
+    }
+
+    void setRemoveHandler(const RemoveHandler & handler)
+    {
+      removeHandler = handler;
+    }
+
   protected:
     void setError(const QString & error)
     {
@@ -91,6 +110,8 @@ class StorageFormat
     QString _error;
     QString _warning;
     Board::Type board;
+    ProgressHandler progressHandler;
+    RemoveHandler removeHandler;
 };
 
 class StorageFactory
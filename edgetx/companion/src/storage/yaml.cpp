@@ -22,62 +22,224 @@
 
 #include <QFile>
 #include <QDir>
+#include <QSaveFile>
+#include <QtEndian>
+
+// see the model journal in radio/src/storage/sdcard_yaml.cpp
+#define MODEL_JOURNAL_EXT      ".jnl"
+#define MODEL_JOURNAL_MAGIC    0x4C4E4A59
+
+YamlFormat::YamlFormat(const QString & filename):
+  CategorizedStorageFormat(filename)
+{
+  QDir dir = QFileInfo(filename).absoluteDir();
+  if (dir.dirName().toUpper() == "RADIO") {
+    dir.cdUp();
+  }
+  root = dir.absolutePath();
+}
+
+QString YamlFormat::getPath(const QString & fileName) const
+{
+  if (fileName == "RADIO/radio.yml")
+    return filename;
+  return root + "/" + fileName;
+}
+
+QString YamlFormat::getModelsPath() const
+{
+  return QDir(root).absoluteFilePath("MODELS");
+}
+
+// The radio saves the changes of the current model in a journal, merged into
+// the model file before it is exported over USB. A journal is left behind
+// when the radio lost power, and applies if made for this very file content.
+bool YamlFormat::hasPendingJournal(const QByteArray & fileData, const QString & path) const
+{
+  QFile journal(path + MODEL_JOURNAL_EXT);
+  if (!journal.open(QFile::ReadOnly))
+    return false;
+
+  QByteArray header = journal.read(8);
+  if (header.size() != 8 || qFromLittleEndian<quint32>(header.constData()) != MODEL_JOURNAL_MAGIC)
+    return false;
+
+  quint32 hash = 2166136261u;  // FNV-1a
+  for (char c : fileData) {
+    hash = (hash ^ (quint8)c) * 16777619u;
+  }
+  return qFromLittleEndian<quint32>(header.constData() + 4) == hash;
+}
 
 bool YamlFormat::loadFile(QByteArray & filedata, const QString & filename)
 {
-  QString path = this->filename + "/" + filename;
-  QFile file(path);
-  if (!file.open(QFile::ReadOnly)) {
-    setError(tr("Error opening file %1:\n%2.").arg(path).arg(file.errorString()));
+  QString path = getPath(filename);
+  QSharedPointer<QFile> file(new QFile(path));
+  if (!file->open(QFile::ReadOnly)) {
+    setError(tr("Error opening file %1:\n%2.").arg(path).arg(file->errorString()));
     return false;
   }
-  filedata = file.readAll();
+
+  // the mapping stays valid until the end of load()
+  const char * data = (const char *)file->map(0, file->size());
+  if (data) {
+    filedata = QByteArray::fromRawData(data, file->size());
+    mappedFiles.append(file);
+  }
+  else {
+    // empty or not mappable
+    filedata = file->readAll();
+  }
+
+  if (filename.startsWith("MODELS/") && filename != "MODELS/models.yml") {
+    loadedFiles.insert(filename);
+    if (hasPendingJournal(filedata, path))
+      journalFiles.append(filename);
+  }
+
   qDebug() << "File" << path << "read, size:" << filedata.size();
-  file.close();
   return true;
 }
 
 bool YamlFormat::writeFile(const QByteArray & filedata, const QString & filename)
 {
-  QString path = this->filename + "/" + filename;
-  QFile file(path);
+  QString path = getPath(filename);
+  writtenFiles.insert(filename);
+
+  QFile current(path);
+  if (current.size() == filedata.size() && current.open(QFile::ReadOnly)) {
+    const char * data = (const char *)current.map(0, current.size());
+    bool unchanged = data ? !memcmp(data, filedata.constData(), filedata.size()) : current.readAll() == filedata;
+    current.close();
+    if (unchanged) {
+      qDebug() << "File" << path << "unchanged";
+      return true;
+    }
+  }
+
+  // written to a temporary file, then renamed
+  QSaveFile file(path);
   if (!file.open(QFile::WriteOnly)) {
     setError(tr("Error opening file %1 in write mode:\n%2.").arg(path).arg(file.errorString()));
     return false;
   }
   file.write(filedata.data(), filedata.size());
-  file.close();
+  if (!file.commit()) {
+    setError(tr("Error writing file %1:\n%2.").arg(path).arg(file.errorString()));
+    return false;
+  }
   qDebug() << "File" << path << "written, size:" << filedata.size();
   return true;
 }
 
+bool YamlFormat::getFileList(std::list<std::string>& filelist)
+{
+  QDir dir(root);
+  if (!dir.cd("MODELS")) return false;
+
+  QStringList ql = dir.entryList(QStringList("*.yml"), QDir::Files);
+  for (const auto& str : ql) {
+    filelist.push_back("MODELS/" + str.toStdString());
+  }
+  return true;
+}
+
 bool YamlFormat::load(RadioData & radioData)
 {
-  QByteArray radioSettingsBuffer;
-  if (!loadFile(radioSettingsBuffer, "RADIO/radio.yml")) {
-    setError(tr("Can't extract RADIO/radio.yml"));
-    return false;
+  loadedFiles.clear();
+  journalFiles.clear();
+
+  bool result = CategorizedStorageFormat::load(radioData);
+  mappedFiles.clear();
+
+  if (result) {
+    radioData.modelsDirectory.path = getModelsPath();
+    radioData.modelsDirectory.owned = loadedFiles;
+    radioData.modelsDirectory.kept.clear();
+
+    if (!journalFiles.isEmpty()) {
+      setWarning(tr("The radio has changes of these models which are not in their files yet:\n%1\n"
+                    "Select another model on the radio, or connect it over USB, to merge them before editing.")
+                 .arg(journalFiles.join("\n")));
+    }
   }
 
-  qDebug() << "Warning: format ignored - under development";
-  return false; // force failure until fully developed
+  return result;
 }
 
 bool YamlFormat::write(const RadioData & radioData)
 {
-  /*  Need this test in case of a new sdcard
-  Board::Type board = getCurrentBoard();
-  if (!HAS_EEPROM_YAML(board)) {
-    qDebug() << "Board does not support YAML format";
-    return false;
-  }
-
   // ensure directories exist on sd card
-  QDir dir(filename);
-  dir.mkdir("RADIO");
+  QDir dir(root);
+  dir.mkpath(QFileInfo(filename).absolutePath());
   dir.mkdir("MODELS");
-  */
 
-  qDebug() << "Warning: format ignored - under development";
-  return false; // force failure until fully developed
+  writtenFiles.clear();
+  bool result = CategorizedStorageFormat::write(radioData);
+  if (result) {
+    removeUnusedModels(radioData);
+  }
+  writtenFiles.clear();
+  return result;
+}
+
+static void removeModel(QDir & dir, const QString & file)
+{
+  if (dir.remove(file)) {
+    qDebug() << "File" << dir.filePath(file) << "removed";
+    // the radio's journal of that model
+    dir.remove(file + MODEL_JOURNAL_EXT);
+  }
+  else {
+    qWarning() << "Cannot remove" << dir.filePath(file);
+  }
+}
+
+// The models deleted, moved or renamed would otherwise be found again by
+// the next load on the radios without categories, which scan MODELS/.
+// Only the files loaded from (or saved to) this directory are removed
+// without asking, the user decides for the other ones.
+void YamlFormat::removeUnusedModels(const RadioData & radioData)
+{
+  QDir dir(root);
+  if (!dir.cd("MODELS")) return;
+
+  RadioData::ModelsDirectory & models = radioData.modelsDirectory;
+  bool sameDirectory = (models.path == getModelsPath());
+  QSet<QString> kept;
+  QStringList unknown;
+
+  const QStringList files = dir.entryList(QStringList("*.yml"), QDir::Files);
+  for (const auto & file : files) {
+    QString name = "MODELS/" + file;
+    if (file == "models.yml" || writtenFiles.contains(name))
+      continue;
+    if (sameDirectory && models.owned.contains(name))
+      removeModel(dir, file);
+    else if (sameDirectory && models.kept.contains(name))
+      kept.insert(name);
+    else
+      unknown.append(file);
+  }
+
+  if (!unknown.isEmpty()) {
+    QStringList paths;
+    for (const auto & file : unknown) {
+      paths.append(QDir::toNativeSeparators(dir.filePath(file)));
+    }
+    if (removeHandler && removeHandler(paths)) {
+      for (const auto & file : unknown) {
+        removeModel(dir, file);
+      }
+    }
+    else {
+      for (const auto & file : unknown) {
+        kept.insert("MODELS/" + file);
+      }
+    }
+  }
+
+  models.path = getModelsPath();
+  models.owned = writtenFiles;
+  models.kept = kept;
 }
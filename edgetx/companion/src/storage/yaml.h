@@ -20,25 +20,46 @@
 
 #pragma once
 
-#include "storage.h"
+#include "categorized.h"
 
 #include <QtCore>
 
-class YamlFormat : public StorageFormat
+// An SD card directory in the YAML format (RADIO/radio.yml, MODELS/*.yml),
+// opened through its radio settings file. The SD card root is the parent
+// of the RADIO directory (or the directory of the file when it isn't named
+// RADIO), the models are in the MODELS directory next to it.
+//
+// The files are memory mapped while loading, and only the files whose
+// content changed are rewritten. The model files loaded from there which
+// are not part of the written data anymore are removed, the other ones only
+// if the user agrees (see RadioData::modelsDirectory).
+class YamlFormat : public CategorizedStorageFormat
 {
   Q_DECLARE_TR_FUNCTIONS(YamlFormat)
 
   public:
-    YamlFormat(const QString & filename):
-      StorageFormat(filename)
-    {
-    }
+    YamlFormat(const QString & filename);
 
     virtual QString name() { return "yml"; }
     virtual bool load(RadioData & radioData);
     virtual bool write(const RadioData & radioData);
 
   protected:
-    bool loadFile(QByteArray & fileData, const QString & fileName);
-    bool writeFile(const QByteArray & fileData, const QString & fileName);
+    virtual bool loadFile(QByteArray & fileData, const QString & fileName);
+    virtual bool writeFile(const QByteArray & fileData, const QString & fileName);
+    virtual bool getFileList(std::list<std::string>& filelist);
+
+    QString getPath(const QString & fileName) const;
+    QString getModelsPath() const;
+    bool hasPendingJournal(const QByteArray & fileData, const QString & path) const;
+    void removeUnusedModels(const RadioData & radioData);
+
+    QString root;
+    // the files mapped by loadFile(), until the end of load()
+    QList<QSharedPointer<QFile>> mappedFiles;
+    // the model files read by load(), and those with a journal from the radio
+    QSet<QString> loadedFiles;
+    QStringList journalFiles;
+    // the files written (or found unchanged) by write()
+    QSet<QString> writtenFiles;
 };
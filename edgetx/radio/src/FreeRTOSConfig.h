@@ -108,6 +108,15 @@ to all Cortex-M ports, and do not rely on any particular library functions. */
 See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
 #define configMAX_SYSCALL_INTERRUPT_PRIORITY 	( configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY << (8 - configPRIO_BITS) )
 	
+#if defined(EVENT_TRACE)
+/* Task events for the binary event trace (needs configUSE_TRACE_FACILITY
+for the task numbers) */
+#include "event_trace.h"
+#define traceTASK_CREATE( pxNewTCB )            eventTraceTaskCreate( ( pxNewTCB )->uxTCBNumber, ( pxNewTCB )->pcTaskName )
+#define traceTASK_SWITCHED_IN()                 eventTraceTaskSwitchedIn( pxCurrentTCB->uxTCBNumber )
+#define traceTASK_INCREMENT_TICK( xTickCount )  eventTraceTick( xTickCount )
+#endif
+
 /* Normal assert() semantics without relying on the provision of an assert.h
 header file. */
 #define configASSERT( x ) if( ( x ) == 0 ) { taskDISABLE_INTERRUPTS(); for( ;; ); }	
@@ -50,7 +50,7 @@ extern FIL g_bluetoothFile;
 #endif
 
 extern Fifo<uint8_t, BT_TX_FIFO_SIZE> btTxFifo;
-extern Fifo<uint8_t, BT_RX_FIFO_SIZE> btRxFifo;
+extern BluetoothRxFifo btRxFifo;
 
 Bluetooth bluetooth;
 
@@ -157,6 +157,85 @@ void Bluetooth::processTrainerFrame(const uint8_t * buffer)
   }
 
   ppmInputValidityTimer = PPM_IN_VALID_TIMEOUT;
+  LATENCY_PROBE_INPUT();
+}
+
+void Bluetooth::processTrainerFrameV2(const uint8_t * buffer, uint8_t length)
+{
+  uint8_t sequence = buffer[1] & 0x7F;
+  bool keyframe = buffer[1] & 0x80;
+  uint16_t mask = buffer[2] + (buffer[3] << 8);
+
+  uint8_t count = 0;
+  for (uint16_t bits = mask; bits; bits >>= 1) {
+    count += bits & 1;
+  }
+  if (length != BLUETOOTH_TRAINER_V2_HEADER + (3 * count + 1) / 2)
+    return;
+
+  // a delta frame is only valid on top of the previous one
+  if (!keyframe && (!trainerSynchronized || sequence != ((trainerSequence + 1) & 0x7F))) {
+    trainerSynchronized = false;
+    return;
+  }
+  trainerSequence = sequence;
+  trainerSynchronized = true;
+  trainerVersion = 2;
+
+  const uint8_t * cur = buffer + BLUETOOTH_TRAINER_V2_HEADER;
+  bool odd = false;
+  for (uint8_t channel = 0; channel < BLUETOOTH_TRAINER_V2_CHANNELS; channel++) {
+    if (!(mask & (1 << channel)))
+      continue;
+    uint16_t value;
+    if (odd) {
+      value = (cur[1] >> 4) + (cur[2] << 4);
+      cur += 3;
+    }
+    else {
+      value = cur[0] + ((cur[1] & 0x0f) << 8);
+    }
+    odd = !odd;
+    // +-500 != 512, but close enough.
+    ppmInput[channel] = value - 1500;
+  }
+
+  ppmInputValidityTimer = PPM_IN_VALID_TIMEOUT;
+  LATENCY_PROBE_INPUT();
+}
+
+void Bluetooth::processFrame(const uint8_t * buffer, uint8_t length)
+{
+  if (buffer[0] == TRAINER_FRAME) {
+    if (length == BLUETOOTH_PACKET_SIZE) {
+      uint8_t crc = 0x00;
+      for (int i = 0; i < BLUETOOTH_PACKET_SIZE - 1; i++) {
+        crc ^= buffer[i];
+      }
+      if (crc == buffer[BLUETOOTH_PACKET_SIZE - 1]) {
+        processTrainerFrame(buffer);
+      }
+    }
+    return;
+  }
+
+  if (length < 3)
+    return;
+
+  length -= 2;
+  if (crc16(CRC_1021, buffer, length) != ((buffer[length] << 8) + buffer[length + 1]))
+    return;
+
+  if (buffer[0] == TRAINER_FRAME_V2 && length >= BLUETOOTH_TRAINER_V2_HEADER) {
+    processTrainerFrameV2(buffer, length);
+  }
+  else if (buffer[0] == TRAINER_HELLO_V2) {
+    if (trainerVersion < 2) {
+      BLUETOOTH_TRACE("[BT] trainer v2" CRLF);
+      trainerVersion = 2;
+      trainerSequence = 0;
+    }
+  }
 }
 
 void Bluetooth::appendTrainerByte(uint8_t data)
@@ -171,8 +250,18 @@ void Bluetooth::appendTrainerByte(uint8_t data)
           state = BLUETOOTH_STATE_DISCONNECTED;
           bufferIndex = 0;
           wakeupTime += 200; // 1s
+          return;
         }
       }
+#if !defined(PCBX9E)
+      if (bufferIndex >= 7 && !strncmp((char *)&buffer[bufferIndex-7], "ERROR\r\n", 7)) {
+        BLUETOOTH_TRACE("BT Reset..." CRLF);
+        bluetoothDisable();
+        state = BLUETOOTH_STATE_OFF;
+        bufferIndex = 0;
+        wakeupTime = get_tmr10ms() + 100; /* 1s */
+      }
+#endif
     }
   }
 }
@@ -182,22 +271,15 @@ void Bluetooth::processTrainerByte(uint8_t data)
   static uint8_t dataState = STATE_DATA_IDLE;
 
   switch (dataState) {
-    case STATE_DATA_START:
-      if (data == START_STOP) {
-        dataState = STATE_DATA_IN_FRAME;
-        bufferIndex = 0;
-      }
-      else {
-        appendTrainerByte(data);
-      }
-      break;
-
     case STATE_DATA_IN_FRAME:
       if (data == BYTE_STUFF) {
         dataState = STATE_DATA_XOR; // XOR next byte
       }
       else if (data == START_STOP) {
-        dataState = STATE_DATA_IN_FRAME;
+        // end of the frame, or start of the next one
+        if (bufferIndex > 0) {
+          processFrame(buffer, bufferIndex);
+        }
         bufferIndex = 0;
       }
       else {
@@ -219,34 +301,21 @@ void Bluetooth::processTrainerByte(uint8_t data)
           break;
         default:  
           // Illegal situation, start looking for a new START_STOP byte
-          dataState = STATE_DATA_START;
+          dataState = STATE_DATA_IDLE;
           break;
       }
       break;
 
-    case STATE_DATA_IDLE:
+    default:
       if (data == START_STOP) {
         bufferIndex = 0;
-        dataState = STATE_DATA_START;
+        dataState = STATE_DATA_IN_FRAME;
       }
       else {
         appendTrainerByte(data);
       }
       break;
   }
-
-  if (bufferIndex >= BLUETOOTH_PACKET_SIZE) {
-    uint8_t crc = 0x00;
-    for (int i = 0; i < BLUETOOTH_PACKET_SIZE - 1; i++) {
-      crc ^= buffer[i];
-    }
-    if (crc == buffer[BLUETOOTH_PACKET_SIZE - 1]) {
-      if (buffer[0] == TRAINER_FRAME) {
-        processTrainerFrame(buffer);
-      }
-    }
-    dataState = STATE_DATA_IDLE;
-  }
 }
 
 void Bluetooth::pushByte(uint8_t byte)
@@ -259,8 +328,94 @@ void Bluetooth::pushByte(uint8_t byte)
   buffer[bufferIndex++] = byte;
 }
 
+void Bluetooth::sendFrame(const uint8_t * frame, uint8_t length)
+{
+  // not in buffer[], which may hold a frame being received
+  uint8_t output[2 + 2 * BLUETOOTH_TRAINER_V2_MAX_SIZE];
+  uint8_t outputIndex = 0;
+
+  uint16_t checksum = crc16(CRC_1021, frame, length);
+  uint8_t trailer[] = { uint8_t(checksum >> 8), uint8_t(checksum) };
+
+  output[outputIndex++] = START_STOP; // start byte
+  for (uint8_t i = 0; i < length + 2; i++) {
+    uint8_t byte = (i < length ? frame[i] : trailer[i - length]);
+    if (byte == START_STOP || byte == BYTE_STUFF) {
+      output[outputIndex++] = BYTE_STUFF;
+      byte ^= STUFF_MASK;
+    }
+    output[outputIndex++] = byte;
+  }
+  output[outputIndex++] = START_STOP; // end byte
+
+  write(output, outputIndex);
+}
+
+void Bluetooth::sendTrainerV2()
+{
+  int16_t PPM_range = g_model.extendedLimits ? 640*2 : 512*2;
+
+  uint8_t firstCh = g_model.trainerData.channelsStart;
+  uint8_t count = min<uint8_t>(BLUETOOTH_TRAINER_V2_CHANNELS, MAX_OUTPUT_CHANNELS - firstCh);
+  bool keyframe = (trainerSequence % BLUETOOTH_TRAINER_V2_KEYFRAME) == 0;
+
+  uint8_t frame[BLUETOOTH_TRAINER_V2_MAX_SIZE];
+  uint8_t * cur = frame + BLUETOOTH_TRAINER_V2_HEADER;
+  uint16_t mask = 0;
+  bool odd = false;
+
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t channel = firstCh + i;
+    uint16_t value = PPM_CH_CENTER(channel) + limit((int16_t)-PPM_range, channelOutputs[channel], (int16_t)PPM_range) / 2;
+    if (!keyframe && value == trainerValues[i])
+      continue;
+    trainerValues[i] = value;
+    mask |= 1 << i;
+    if (odd) {
+      cur[1] |= value << 4;
+      cur[2] = value >> 4;
+      cur += 3;
+    }
+    else {
+      cur[0] = value;
+      cur[1] = (value >> 8) & 0x0f;
+    }
+    odd = !odd;
+  }
+  if (odd) {
+    cur += 2;
+  }
+
+  frame[0] = TRAINER_FRAME_V2;
+  frame[1] = (trainerSequence & 0x7F) | (keyframe ? 0x80 : 0);
+  frame[2] = mask;
+  frame[3] = mask >> 8;
+  trainerSequence++;
+
+  sendFrame(frame, cur - frame);
+}
+
+void Bluetooth::sendTrainerHello()
+{
+  uint8_t frame[] = { TRAINER_HELLO_V2, BLUETOOTH_TRAINER_V2_CHANNELS };
+  sendFrame(frame, sizeof(frame));
+}
+
+void Bluetooth::resetTrainer()
+{
+  trainerVersion = 1;
+  trainerSequence = 0;
+  trainerSynchronized = false;
+  trainerHelloTime = 0;
+}
+
 void Bluetooth::sendTrainer()
 {
+  if (trainerVersion >= 2) {
+    sendTrainerV2();
+    return;
+  }
+
   int16_t PPM_range = g_model.extendedLimits ? 640*2 : 512*2;
 
   int firstCh = g_model.trainerData.channelsStart;
@@ -296,30 +451,115 @@ void Bluetooth::sendTrainer()
   bufferIndex = 0;
 }
 
+// same framing as the S.Port packets forwarded by OpenTX, so that the
+// phone apps keep working
+static uint8_t encodeTelemetryPacket(uint8_t * output, const uint8_t * packet)
+{
+  uint8_t length = 0;
+  uint8_t crc = 0x00;
+
+  output[length++] = START_STOP; // start byte
+  for (uint8_t i = 0; i < sizeof(SportTelemetryPacket); i++) {
+    uint8_t byte = packet[i];
+    crc ^= byte;
+    if (byte == START_STOP || byte == BYTE_STUFF) {
+      output[length++] = BYTE_STUFF;
+      byte ^= STUFF_MASK;
+    }
+    output[length++] = byte;
+  }
+  output[length++] = crc;
+  output[length++] = START_STOP; // end byte
+
+  return length;
+}
+
+static bool isCriticalTelemetry(uint16_t dataId)
+{
+  return dataId == RSSI_ID || dataId == BATT_ID || dataId == ADC2_ID ||
+         (dataId >= VFAS_FIRST_ID && dataId <= VFAS_LAST_ID) ||
+         (dataId >= CELLS_FIRST_ID && dataId <= CELLS_LAST_ID);
+}
+
 void Bluetooth::forwardTelemetry(const uint8_t * packet)
 {
-  crc = 0x00;
+  const SportTelemetryPacket * sport = (const SportTelemetryPacket *)packet;
 
-  buffer[bufferIndex++] = START_STOP; // start byte
-  for (uint8_t i=0; i<sizeof(SportTelemetryPacket); i++) {
-    pushByte(packet[i]);
+  if (sport->primId != DATA_FRAME) {
+    // replies to requests are not coalesced
+    uint8_t output[BLUETOOTH_TELEMETRY_PACKET_MAX_SIZE];
+    write(output, encodeTelemetryPacket(output, packet));
+    return;
   }
-  buffer[bufferIndex++] = crc;
-  buffer[bufferIndex++] = START_STOP; // end byte
 
-  if (bufferIndex >= 2*FRSKY_SPORT_PACKET_SIZE) {
-    write(buffer, bufferIndex);
-    bufferIndex = 0;
+  // keep the latest value of each sensor, sent by sendTelemetry()
+  BluetoothTelemetrySlot * available = nullptr;
+  for (auto & slot: telemetrySlots) {
+    if (slot.used && slot.packet.physicalId == sport->physicalId && slot.packet.dataId == sport->dataId) {
+      memcpy(slot.packet.raw, packet, sizeof(SportTelemetryPacket));
+      slot.fresh = true;
+      return;
+    }
+    if (!available && (!slot.used || !slot.fresh)) {
+      available = &slot;
+    }
   }
 
-  // If not in verbose mode output one buffer per line
-  #if defined(DEBUG_BLUETOOTH) && !defined(DEBUG_BLUETOOTH_VERBOSE)
+  if (available) {
+    memcpy(available->packet.raw, packet, sizeof(SportTelemetryPacket));
+    available->used = true;
+    available->fresh = true;
+    available->critical = isCriticalTelemetry(sport->dataId);
+  }
+  else {
+    telemetryDropped++;
+  }
+}
+
+void Bluetooth::sendTelemetry()
+{
+  uint8_t output[BT_TX_FIFO_SIZE - 1];
+  uint32_t length = 0;
+  uint32_t budget = sizeof(output) - btTxFifo.size();
+  bool full = false;
+
+  // critical sensors first, then the others in turn, as long as they fit
+  for (uint8_t pass = 0; pass < 2 && !full; pass++) {
+    for (uint8_t i = 0; i < BLUETOOTH_TELEMETRY_SLOTS; i++) {
+      uint8_t index = (telemetryCursor + i) % BLUETOOTH_TELEMETRY_SLOTS;
+      BluetoothTelemetrySlot & slot = telemetrySlots[index];
+      if (!slot.fresh || slot.critical != (pass == 0))
+        continue;
+      if (length + BLUETOOTH_TELEMETRY_PACKET_MAX_SIZE > budget) {
+        if (pass > 0)
+          telemetryCursor = index;
+        full = true;
+        break;
+      }
+      length += encodeTelemetryPacket(output + length, slot.packet.raw);
+      slot.fresh = false;
+    }
+  }
+
+  if (length > 0) {
+    write(output, length);
+
+    // If not in verbose mode output one buffer per line
+#if defined(DEBUG_BLUETOOTH) && !defined(DEBUG_BLUETOOTH_VERBOSE)
     BLUETOOTH_TRACE_TIMESTAMP();
-    for(int i=0; i < bufferIndex; i++) {
-      BLUETOOTH_TRACE(" %02X", buffer[i]);
+    for (uint32_t i = 0; i < length; i++) {
+      BLUETOOTH_TRACE(" %02X", output[i]);
     }
     BLUETOOTH_TRACE(CRLF);
-  #endif
+#endif
+  }
+}
+
+void Bluetooth::resetTelemetry()
+{
+  memclear(telemetrySlots, sizeof(telemetrySlots));
+  telemetryCursor = 0;
+  telemetryTime = 0;
 }
 
 void Bluetooth::receiveTrainer()
@@ -450,12 +690,27 @@ void Bluetooth::wakeup()
   }
   else if (state == BLUETOOTH_STATE_CONNECTED) {
     if (g_eeGeneral.bluetoothMode == BLUETOOTH_TRAINER && g_model.trainerData.mode == TRAINER_MODE_MASTER_BLUETOOTH) {
+      wakeupTime = now; // process the frames as soon as they arrive
       receiveTrainer();
+      if (state == BLUETOOTH_STATE_CONNECTED && trainerVersion < 2 && now >= trainerHelloTime) {
+        sendTrainerHello();
+        trainerHelloTime = now + 100; /* 1s */
+      }
     }
-    else {
-      if (g_eeGeneral.bluetoothMode == BLUETOOTH_TRAINER && g_model.trainerData.mode == TRAINER_MODE_SLAVE_BLUETOOTH) {
+    else if (g_eeGeneral.bluetoothMode == BLUETOOTH_TRAINER && g_model.trainerData.mode == TRAINER_MODE_SLAVE_BLUETOOTH) {
+      receiveTrainer(); // v2 hello, "DisConnected", "ERROR"
+      if (state == BLUETOOTH_STATE_CONNECTED) {
         sendTrainer();
-        wakeupTime = now + 2; /* 20ms */
+        wakeupTime = now + (trainerVersion >= 2 ? 1 : 2); /* 10ms / 20ms */
+      }
+    }
+    else {
+      if (g_eeGeneral.bluetoothMode == BLUETOOTH_TELEMETRY) {
+        if (now >= telemetryTime) {
+          sendTelemetry();
+          telemetryTime = now + BLUETOOTH_TELEMETRY_PERIOD;
+        }
+        wakeupTime = min<tmr10ms_t>(wakeupTime, telemetryTime);
       }
       readline(); // to deal with "ERROR"
     }
@@ -524,6 +779,8 @@ void Bluetooth::wakeup()
     else if ((state == BLUETOOTH_STATE_IDLE || state == BLUETOOTH_STATE_DISCONNECTED || state == BLUETOOTH_STATE_CONNECT_SENT) && !strncmp(line, "Connected:", 10)) {
       strcpy(distantAddr, &line[10]); // TODO quick & dirty
       state = BLUETOOTH_STATE_CONNECTED;
+      resetTrainer();
+      resetTelemetry();
       if (g_model.trainerData.mode == TRAINER_MODE_SLAVE_BLUETOOTH) {
         wakeupTime += 500; // it seems a 5s delay is needed before sending the 1st frame
       }
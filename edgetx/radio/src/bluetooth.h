@@ -48,9 +48,43 @@ enum BluetoothStates {
 #define LEN_BLUETOOTH_ADDR              16
 #define MAX_BLUETOOTH_DISTANT_ADDR      6
 #define BLUETOOTH_PACKET_SIZE           14
-#define BLUETOOTH_LINE_LENGTH           32
+#define BLUETOOTH_LINE_LENGTH           64  // power of 2, also holds a stuffed v2 trainer frame
 #define BLUETOOTH_TRAINER_CHANNELS      8
 
+// Trainer frames v2, before byte stuffing:
+//   TRAINER_FRAME_V2, sequence (bit 7: key frame), channels mask (LE),
+//   values (12 bits, 2 values in 3 bytes), CRC16 (BE)
+// Only the channels which changed are sent, the others keep their value.
+// Key frames carry all the channels, a receiver which missed a frame
+// ignores the next ones until the next key frame.
+// The master sends TRAINER_HELLO_V2 frames until it receives v2 frames,
+// the slave only sends v2 frames once it received one, so that both stay
+// compatible with v1 radios.
+#define BLUETOOTH_TRAINER_V2_CHANNELS   16
+#define BLUETOOTH_TRAINER_V2_KEYFRAME   8   // one key frame every 8 frames
+#define BLUETOOTH_TRAINER_V2_HEADER     4
+#define BLUETOOTH_TRAINER_V2_MAX_SIZE   (BLUETOOTH_TRAINER_V2_HEADER + BLUETOOTH_TRAINER_V2_CHANNELS * 3 / 2 + 2)
+
+// Telemetry forwarding: the latest S.Port packet of each sensor is kept,
+// and all the updated sensors are sent together every period (10ms unit),
+// critical ones (RSSI, batteries) first, the others in turn as long as
+// they fit in the TX fifo.
+#if !defined(BLUETOOTH_TELEMETRY_SLOTS)
+  #define BLUETOOTH_TELEMETRY_SLOTS     32
+#endif
+#if !defined(BLUETOOTH_TELEMETRY_PERIOD)
+  #define BLUETOOTH_TELEMETRY_PERIOD    5   // 50ms
+#endif
+#define BLUETOOTH_TELEMETRY_PACKET_MAX_SIZE  (2 + 2 * 8 + 1) // start, stuffed packet, crc, end
+
+struct BluetoothTelemetrySlot
+{
+  SportTelemetryPacket packet;
+  bool used;
+  bool fresh;    // not sent yet
+  bool critical;
+};
+
 #if defined(LOG_BLUETOOTH)
   #define BLUETOOTH_TRACE(...)  \
     f_printf(&g_bluetoothFile, __VA_ARGS__); \
@@ -79,6 +113,7 @@ class Bluetooth
     void write(const uint8_t * data, uint8_t length);
 
     void forwardTelemetry(const uint8_t * packet);
+    uint32_t getTelemetryDropped() const { return telemetryDropped; }
     void wakeup();
     const char * flashFirmware(const char * filename, ProgressHandler progressHandler);
 
@@ -91,9 +126,17 @@ class Bluetooth
     uint8_t read(uint8_t * data, uint8_t size, uint32_t timeout=1000/*ms*/);
     void appendTrainerByte(uint8_t data);
     void processTrainerFrame(const uint8_t * buffer);
+    void processTrainerFrameV2(const uint8_t * buffer, uint8_t length);
+    void processFrame(const uint8_t * buffer, uint8_t length);
     void processTrainerByte(uint8_t data);
+    void sendFrame(const uint8_t * frame, uint8_t length);
     void sendTrainer();
+    void sendTrainerV2();
+    void sendTrainerHello();
     void receiveTrainer();
+    void resetTrainer();
+    void sendTelemetry();
+    void resetTelemetry();
 
     uint8_t bootloaderChecksum(uint8_t command, const uint8_t * data, uint8_t size);
     void bootloaderSendCommand(uint8_t command, const void *data = nullptr, uint8_t size = 0);
@@ -113,6 +156,17 @@ class Bluetooth
     uint8_t bufferIndex = 0;
     tmr10ms_t wakeupTime = 0;
     uint8_t crc;
+
+    uint8_t trainerVersion = 1;
+    uint8_t trainerSequence = 0;
+    bool trainerSynchronized = false;
+    tmr10ms_t trainerHelloTime = 0;
+    uint16_t trainerValues[BLUETOOTH_TRAINER_V2_CHANNELS];
+
+    BluetoothTelemetrySlot telemetrySlots[BLUETOOTH_TELEMETRY_SLOTS];
+    uint8_t telemetryCursor = 0;
+    tmr10ms_t telemetryTime = 0;
+    uint32_t telemetryDropped = 0;
 };
 
 extern Bluetooth bluetooth;
@@ -73,8 +73,7 @@ struct MemArea
 
 void cliPrompt()
 {
-  serialPutc('>');
-  serialPutc(' ');
+  serialWrite("> ", 2);
 }
 
 int toLongLongInt(const char ** argv, int index, long long int * val)
@@ -718,6 +717,25 @@ int cliTrace(const char ** argv)
   return 0;
 }
 
+#if defined(EVENT_TRACE)
+int cliEventTrace(const char ** argv)
+{
+  if (!strcmp(argv[1], "usb")) {
+    eventTraceStart(EVENT_TRACE_OUTPUT_USB);
+  }
+  else if (!strcmp(argv[1], "aux")) {
+    eventTraceStart(EVENT_TRACE_OUTPUT_AUX);
+  }
+  else if (!strcmp(argv[1], "off")) {
+    eventTraceStop();
+  }
+  else {
+    serialPrint("%s: Invalid argument \"%s\"", argv[0], argv[1]);
+  }
+  return 0;
+}
+#endif
+
 int cliStackInfo(const char ** argv)
 {
   serialPrint("[MAIN] %d available / %d bytes", stackAvailable()*4, stackSize()*4);
@@ -1003,16 +1021,20 @@ int cliSerialPassthrough(const char **argv)
       // loop until cable disconnected
       while (cdcConnected) {
 
-        uint8_t data;
-        if (intmoduleFifo.pop(data)) {
+        uint8_t data[64];
+        size_t len = 0;
+        while (len < sizeof(data) && intmoduleFifo.pop(data[len])) {
+          len++;
+        }
 
-          uint8_t timeout = 10; // 10 ms
-          while(!usbSerialFreeSpace() && (timeout > 0)) {
+        size_t sent = 0;
+        uint8_t timeout = 10; // 10 ms
+        while (sent < len) {
+          sent += usbSerialWrite(data + sent, len - sent);
+          if (sent < len) {
+            if (timeout-- == 0) break;
             delay_ms(1);
-            timeout--;
           }
-
-          usbSerialPutc(data);
         }
 
         // keep us up & running
@@ -1078,19 +1100,53 @@ void printDebugTime(uint32_t time)
 
 void printDebugTimer(const char * name, DebugTimer & timer)
 {
-  serialPrintf("%s: ", name);
-  printDebugTime( timer.getMin());
+  DebugTimerStats stats;
+  timer.getStats(stats);
+  timer.reset();
+
+  serialPrintf("%s: n=%u ", name, stats.count);
+  printDebugTime(stats.min);
   serialPrintf(" - ");
-  printDebugTime(timer.getMax());
+  printDebugTime(stats.max);
+  serialPrintf(" avg ");
+  printDebugTime(stats.avg);
+  serialPrintf(" p50 ");
+  printDebugTime(stats.p50);
+  serialPrintf(" p99 ");
+  printDebugTime(stats.p99);
+  serialPrintf(" p99.9 ");
+  printDebugTime(stats.p999);
   serialCrlf();
-  timer.reset();
 }
+
 void printDebugTimers()
 {
   for(int n = 0; n < DEBUG_TIMERS_COUNT; n++) {
     printDebugTimer(debugTimerNames[n], debugTimers[n]);
   }
 }
+
+void printDebugTimerHistogram(const char * name, DebugTimer & timer)
+{
+  for (uint8_t i = 0; i < DEBUG_TIMER_BUCKETS; i++) {
+    uint16_t count = timer.getBucket(i);
+    if (count > 0) {
+      printDebugTime(DebugTimer::getBucketValue(i));
+      serialPrintf(": %u", count);
+      serialCrlf();
+    }
+  }
+  printDebugTimer(name, timer);
+}
+#endif
+
+#if defined(LATENCY_PROBE)
+void printLatencyProbe()
+{
+  for (int n = 0; n < LATENCY_PROBE_STAGES; n++) {
+    printDebugTimer(latencyProbeStageNames[n], latencyProbeGetStage(n));
+  }
+}
 #endif
 
 #if defined(DEBUG_AUDIO)
@@ -1235,7 +1291,32 @@ int cliDisplay(const char ** argv)
 #endif
 #if defined(DEBUG_TIMERS)
   else if (!strcmp(argv[1], "dt")) {
-    printDebugTimers();
+    int index;
+    int result = toInt(argv, 2, &index);
+    if (result == 0) {
+      printDebugTimers();
+    }
+    else if (result > 0) {
+      if (index >= 0 && index < DEBUG_TIMERS_COUNT)
+        printDebugTimerHistogram(debugTimerNames[index], debugTimers[index]);
+      else
+        serialPrint("%s: Invalid timer \"%s\"", argv[0], argv[2]);
+    }
+  }
+#endif
+#if defined(LATENCY_PROBE)
+  else if (!strcmp(argv[1], "latency")) {
+    int index;
+    int result = toInt(argv, 2, &index);
+    if (result == 0) {
+      printLatencyProbe();
+    }
+    else if (result > 0) {
+      if (index >= 0 && index < LATENCY_PROBE_STAGES)
+        printDebugTimerHistogram(latencyProbeStageNames[index], latencyProbeGetStage(index));
+      else
+        serialPrint("%s: Invalid stage \"%s\"", argv[0], argv[2]);
+    }
   }
 #endif
 #if defined(DEBUG_AUDIO)
@@ -1248,6 +1329,14 @@ int cliDisplay(const char ** argv)
     DiskCacheStats stats = diskCache.getStats();
     uint32_t hitRate = diskCache.getHitRate();
     serialPrint("Disk Cache stats: w:%u r: %u, h: %u(%0.1f%%), m: %u", stats.noWrites, (stats.noHits + stats.noMisses), stats.noHits, hitRate*0.1f, stats.noMisses);
+    serialPrint("Flushes: %u", stats.noFlushes);
+    serialPrint("Read-ahead: %u blocks, %u used", stats.noReadAheads, stats.noReadAheadHits);
+    for (int n = 0; n < DISK_CACHE_STREAMS; n++) {
+      const DiskCacheStreamStats & stream = stats.streams[n];
+      if (stream.noReads > 0) {
+        serialPrint("Stream %d @%u: r: %u, h: %u, m: %u, ra: %u", n, stream.startSector, stream.noReads, stream.noHits, stream.noMisses, stream.noReadAheads);
+      }
+    }
   }
 #endif
   else if (toLongLongInt(argv, 1, &address) > 0) {
@@ -1368,6 +1457,9 @@ int cliBlueTooth(const char ** argv)
       serialPrint("BT turned off");
     }
   }
+  else if (!strcmp(argv[1], "telemetry")) {
+    serialPrint("BT telemetry period: %d0ms, dropped: %u", BLUETOOTH_TELEMETRY_PERIOD, bluetooth.getTelemetryDropped());
+  }
   else {
     serialPrint("%s: Invalid arguments", argv[0]);
   }
@@ -1445,6 +1537,9 @@ const CliCommand cliCommands[] = {
   { "meminfo", cliMemoryInfo, "" },
   { "test", cliTest, "new | graphics | memspd" },
   { "trace", cliTrace, "on | off" },
+#if defined(EVENT_TRACE)
+  { "eventtrace", cliEventTrace, "usb | aux | off" },
+#endif
   { "debugvars", cliDebugVars, "" },
   { "repeat", cliRepeat, "<interval> <command>" },
 #endif
@@ -1456,7 +1551,7 @@ const CliCommand cliCommands[] = {
   { "gps", cliGps, "<baudrate>|$<command>|trace" },
 #endif
 #if defined(BLUETOOTH)
-  { "bt", cliBlueTooth, "<baudrate>|<command>" },
+  { "bt", cliBlueTooth, "<baudrate>|<command>|telemetry" },
 #endif
 #if defined(ACCESS_DENIED) && defined(DEBUG_CRYPT)
   { "crypt", cliCrypt, "<string to be encrypted>" },
@@ -1552,7 +1647,7 @@ void cliTask(void * pdata)
     case CHAR_BACKSPACE:
       if (pos) {
         line[--pos] = '\0';
-        serialPutc(c);
+        serialWrite((const char *)&c, 1);
       }
       break;
 
@@ -1581,7 +1676,7 @@ void cliTask(void * pdata)
     default:
       if (isascii(c) && pos < CLI_COMMAND_MAX_LEN) {
         line[pos++] = c;
-        serialPutc(c);
+        serialWrite((const char *)&c, 1);
       }
       break;
     }
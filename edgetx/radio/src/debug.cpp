@@ -48,7 +48,6 @@ void debugPrintf(const char * format, ...)
 #if defined(DEBUG_TRACE_BUFFER)
 static struct TraceElement traceBuffer[TRACE_BUFFER_LEN];
 static uint8_t traceBufferPos;
-extern Fifo<uint8_t, 512> auxSerialTxFifo;
 gtime_t filltm(const gtime_t *t, struct gtm *tp);
 
 void trace_event(enum TraceEvent event, uint32_t data)
@@ -204,6 +203,88 @@ void DebugTimer::stop()
   evalStats(); 
 }
 
+uint8_t DebugTimer::getBucketIndex(debug_timer_t value)
+{
+  if (value < DEBUG_TIMER_HISTOGRAM_SUB)
+    return value;
+
+  uint8_t bits = 31 - __builtin_clz(value);
+  if (bits >= DEBUG_TIMER_HISTOGRAM_BITS)
+    return DEBUG_TIMER_BUCKETS - 1;
+
+  uint8_t sub = (value >> (bits - DEBUG_TIMER_HISTOGRAM_SUB_BITS)) & (DEBUG_TIMER_HISTOGRAM_SUB - 1);
+  return (bits - DEBUG_TIMER_HISTOGRAM_SUB_BITS + 1) * DEBUG_TIMER_HISTOGRAM_SUB + sub;
+}
+
+debug_timer_t DebugTimer::getBucketValue(uint8_t index)
+{
+  if (index < DEBUG_TIMER_HISTOGRAM_SUB)
+    return index;
+
+  uint8_t bits = index / DEBUG_TIMER_HISTOGRAM_SUB + DEBUG_TIMER_HISTOGRAM_SUB_BITS - 1;
+  uint8_t sub = index % DEBUG_TIMER_HISTOGRAM_SUB;
+  return (DEBUG_TIMER_HISTOGRAM_SUB + sub) << (bits - DEBUG_TIMER_HISTOGRAM_SUB_BITS);
+}
+
+void DebugTimer::evalStats()
+{
+  if (min > last) min = last;
+  if (max < last) max = last;
+  count++;
+  sum += last;
+
+  uint16_t & bucket = histogram[getBucketIndex(last)];
+  if (bucket == UINT16_MAX) {
+    // keep the shape of the distribution rather than saturate one bucket
+    for (auto & b: histogram) {
+      b = (b + 1) / 2;
+    }
+  }
+  bucket++;
+}
+
+void DebugTimer::reset()
+{
+  min = -1;
+  max = last = 0;
+  count = 0;
+  sum = 0;
+  memset(histogram, 0, sizeof(histogram));
+}
+
+debug_timer_t DebugTimer::getPercentile(uint16_t permyriad) const
+{
+  uint32_t total = 0;
+  for (auto b: histogram) {
+    total += b;
+  }
+  if (total == 0)
+    return 0;
+
+  uint32_t target = (total * permyriad + 9999) / 10000;
+  uint32_t cumulated = 0;
+  for (uint8_t i = 0; i < DEBUG_TIMER_BUCKETS; i++) {
+    cumulated += histogram[i];
+    if (cumulated >= target) {
+      // the upper bound of the bucket, within the measured range
+      debug_timer_t value = (i == DEBUG_TIMER_BUCKETS - 1 ? max : getBucketValue(i + 1) - 1);
+      return limit<debug_timer_t>(min, value, max);
+    }
+  }
+  return max;
+}
+
+void DebugTimer::getStats(DebugTimerStats & stats) const
+{
+  stats.count = count;
+  stats.min = (count ? min : 0);
+  stats.max = max;
+  stats.avg = getAvg();
+  stats.p50 = getPercentile(5000);
+  stats.p99 = getPercentile(9900);
+  stats.p999 = getPercentile(9990);
+}
+
 DebugTimer debugTimers[DEBUG_TIMERS_COUNT];
 
 const char * const debugTimerNames[DEBUG_TIMERS_COUNT] = {
@@ -329,35 +329,66 @@ extern struct InterruptCounters interruptCounters;
 #if defined(__cplusplus)
 typedef uint32_t debug_timer_t;
 
+// Log-scale histogram of the measured times: values below 4us have their
+// own bucket, then each power of two is split into 4 buckets (25% max
+// error), up to 2^DEBUG_TIMER_HISTOGRAM_BITS us. Longer times go in the
+// last bucket.
+#define DEBUG_TIMER_HISTOGRAM_SUB_BITS  2
+#define DEBUG_TIMER_HISTOGRAM_SUB       (1 << DEBUG_TIMER_HISTOGRAM_SUB_BITS)
+#define DEBUG_TIMER_HISTOGRAM_BITS      20
+#define DEBUG_TIMER_BUCKETS             ((DEBUG_TIMER_HISTOGRAM_BITS - 1) * DEBUG_TIMER_HISTOGRAM_SUB)
+
+struct DebugTimerStats
+{
+  uint32_t count;
+  debug_timer_t min;
+  debug_timer_t max;
+  debug_timer_t avg;
+  debug_timer_t p50;
+  debug_timer_t p99;
+  debug_timer_t p999;
+};
+
 class DebugTimer
 {
 private:
   debug_timer_t min;
   debug_timer_t max;
-  // debug_timer_t avg;
   debug_timer_t last;   //unit 1us
+  uint32_t count;
+  uint64_t sum;
+  uint16_t histogram[DEBUG_TIMER_BUCKETS];
 
   uint16_t _start_hiprec;
   uint32_t _start_loprec;
 
-  void evalStats() {
-    if (min > last) min = last;
-    if (max < last) max = last;
-    //todo avg
-  }
+  void evalStats();
 
 public:
-  DebugTimer(): min(-1), max(0), /*avg(0),*/ last(0), _start_hiprec(0), _start_loprec(0) {};
+  DebugTimer(): min(-1), max(0), last(0), count(0), sum(0), histogram(), _start_hiprec(0), _start_loprec(0) {};
 
   void start();
   void stop();
   void sample() { stop(); start(); }
+  // time measured elsewhere, in us
+  void addSample(debug_timer_t value) { last = value; evalStats(); }
 
-  void reset() { min = -1;  max = last = 0; }
+  void reset();
 
   debug_timer_t getMin() const { return min; }
   debug_timer_t getMax() const { return max; }
   debug_timer_t getLast() const { return last; }
+  uint32_t getCount() const { return count; }
+  debug_timer_t getAvg() const { return count ? sum / count : 0; }
+
+  // permyriad: 5000 for the median, 9900 for p99, 9990 for p99.9
+  debug_timer_t getPercentile(uint16_t permyriad) const;
+  void getStats(DebugTimerStats & stats) const;
+
+  uint16_t getBucket(uint8_t index) const { return histogram[index]; }
+  static uint8_t getBucketIndex(debug_timer_t value);
+  // lowest value in the bucket
+  static debug_timer_t getBucketValue(uint8_t index);
 };
 
 enum DebugTimers {
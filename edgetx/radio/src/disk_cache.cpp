@@ -33,133 +33,515 @@
   #define TRACE_DISK_CACHE(...)
 #endif
 
+// a stream needs this many consecutive reads before read-ahead starts
+#define DISK_CACHE_SEQUENTIAL_READS   2
+
+static_assert(DISK_CACHE_BLOCK_SECTORS <= 32, "Sector masks are 32 bits");
+static_assert(DISK_CACHE_DIRTY_MAX < DISK_CACHE_BLOCKS_NUM, "Clean blocks are needed for reads");
+
 DiskCache diskCache;
 
+static inline uint32_t getHashIndex(DWORD blockNo)
+{
+  return blockNo & (DISK_CACHE_HASH_SIZE - 1);
+}
+
+static inline uint32_t getSectorsMask(DWORD sector, UINT count)
+{
+  return (DISK_CACHE_BLOCK_MASK >> (DISK_CACHE_BLOCK_SECTORS - count)) << (sector % DISK_CACHE_BLOCK_SECTORS);
+}
+
 DiskCacheBlock::DiskCacheBlock():
-  startSector(0),
-  endSector(0) 
+  blockNo(0),
+  lastUsed(0),
+  lastWritten(0),
+  validMask(0),
+  dirtyMask(0),
+  next(-1),
+  readAhead(false)
+{
+}
+
+bool DiskCacheBlock::contains(DWORD sector, UINT count) const
+{
+  uint32_t mask = getSectorsMask(sector, count);
+  return (validMask & mask) == mask;
+}
+
+void DiskCacheBlock::read(BYTE * buff, DWORD sector, UINT count) const
+{
+  TRACE_DISK_CACHE("\tcache read(%u, %u) from %p", (uint32_t)sector, (uint32_t)count, this);
+  memcpy(buff, data + ((sector % DISK_CACHE_BLOCK_SECTORS) * BLOCK_SIZE), count * BLOCK_SIZE);
+}
+
+void DiskCacheBlock::free()
+{
+  validMask = 0;
+  dirtyMask = 0;
+  readAhead = false;
+}
+
+bool DiskCacheBlock::empty() const
+{
+  return validMask == 0;
+}
+
+DiskCache::DiskCache():
+  clock(0)
+{
+  blocks = new DiskCacheBlock[DISK_CACHE_BLOCKS_NUM];
+  readAheadBuffer = new uint32_t[DISK_CACHE_READ_AHEAD_MAX * DISK_CACHE_BLOCK_SIZE / sizeof(uint32_t)];
+  clear();
+}
+
+void DiskCache::clear()
 {
+  clock = 0;
+  dirtyBlocks = 0;
+  memset(&stats, 0, sizeof(stats));
+  memset(streams, 0, sizeof(streams));
+  memset(hashTable, -1, sizeof(hashTable));
+  for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
+    blocks[n].free();
+    blocks[n].next = -1;
+  }
 }
 
-bool DiskCacheBlock::read(BYTE * buff, DWORD sector, UINT count)
+DiskCacheBlock * DiskCache::find(DWORD blockNo)
 {
-  if (sector >= startSector && (sector+count) <= endSector) {
-    TRACE_DISK_CACHE("\tcache read(%u, %u) from %p", (uint32_t)sector, (uint32_t)count, this);
-    memcpy(buff, data + ((sector - startSector) * BLOCK_SIZE), count * BLOCK_SIZE);
-    return true;
+  for (int8_t n = hashTable[getHashIndex(blockNo)]; n >= 0; n = blocks[n].next) {
+    if (blocks[n].blockNo == blockNo) {
+      return &blocks[n];
+    }
   }
-  return false;
+  return nullptr;
 }
 
-DRESULT DiskCacheBlock::fill(BYTE drv, BYTE * buff, DWORD sector, UINT count)
+void DiskCache::unlink(DiskCacheBlock * block)
 {
-  DRESULT res = __disk_read(drv, data, sector, DISK_CACHE_BLOCK_SECTORS);
+  int8_t * link = &hashTable[getHashIndex(block->blockNo)];
+  while (*link >= 0) {
+    if (&blocks[*link] == block) {
+      *link = block->next;
+      break;
+    }
+    link = &blocks[*link].next;
+  }
+  if (block->dirtyMask) {
+    --dirtyBlocks;
+  }
+  block->next = -1;
+  block->free();
+}
+
+// take a free block, or else the least recently used clean one
+DiskCacheBlock * DiskCache::allocate(DWORD blockNo)
+{
+  DiskCacheBlock * block = nullptr;
+  for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
+    if (blocks[n].empty()) {
+      block = &blocks[n];
+      break;
+    }
+    if (!blocks[n].dirtyMask && (!block || blocks[n].lastUsed < block->lastUsed)) {
+      block = &blocks[n];
+    }
+  }
+
+  if (!block) {
+    // only possible after write errors: drop the oldest dirty data
+    block = &blocks[0];
+    for (int n=1; n<DISK_CACHE_BLOCKS_NUM; ++n) {
+      if (blocks[n].lastUsed < block->lastUsed) {
+        block = &blocks[n];
+      }
+    }
+    TRACE("disk cache: dropping dirty block %u", (uint32_t)block->blockNo);
+  }
+
+  if (!block->empty()) {
+    TRACE_DISK_CACHE("\t\t evicting block %u", (uint32_t)block->blockNo);
+    unlink(block);
+  }
+
+  uint32_t index = getHashIndex(blockNo);
+  block->blockNo = blockNo;
+  block->lastUsed = ++clock;
+  block->next = hashTable[index];
+  hashTable[index] = block - blocks;
+  return block;
+}
+
+// Streams are detected when a read starts in the block where the previous
+// read of a tracked stream ended. Returns the stream index, a new stream
+// replacing the least recently used one if needed.
+int DiskCache::getStream(DWORD sector, UINT count)
+{
+  int result = 0;
+
+  for (int n=0; n<DISK_CACHE_STREAMS; ++n) {
+    DiskCacheStream & stream = streams[n];
+    if (stream.nextSector && sector >= stream.nextSector && sector < stream.nextSector + DISK_CACHE_BLOCK_SECTORS) {
+      stream.nextSector = sector + count;
+      stream.lastUsed = clock;
+      if (stream.sequentialReads < DISK_CACHE_SEQUENTIAL_READS) {
+        if (++stream.sequentialReads == DISK_CACHE_SEQUENTIAL_READS) {
+          stream.readAhead = 2;
+        }
+      }
+      stats.streams[n].noReads++;
+      return n;
+    }
+    if (stream.lastUsed < streams[result].lastUsed) {
+      result = n;
+    }
+  }
+
+  DiskCacheStream & stream = streams[result];
+  stream.nextSector = sector + count;
+  stream.lastUsed = clock;
+  stream.sequentialReads = 0;
+  stream.readAhead = 1;
+  memset(&stats.streams[result], 0, sizeof(DiskCacheStreamStats));
+  stats.streams[result].startSector = sector;
+  stats.streams[result].noReads = 1;
+  return result;
+}
+
+// read blocksCount consecutive blocks (not in the cache) with a single multi-block transfer
+DRESULT DiskCache::fill(BYTE drv, DWORD blockNo, UINT blocksCount)
+{
+  if (blocksCount == 1) {
+    DiskCacheBlock * block = allocate(blockNo);
+    DRESULT res = __disk_read(drv, block->data, blockNo * DISK_CACHE_BLOCK_SECTORS, DISK_CACHE_BLOCK_SECTORS);
+    if (res == RES_OK) {
+      block->validMask = DISK_CACHE_BLOCK_MASK;
+    }
+    else {
+      unlink(block);
+    }
+    TRACE_DISK_CACHE("\tcache %p FILLED with block %u", block, (uint32_t)blockNo);
+    return res;
+  }
+
+  DRESULT res = __disk_read(drv, (BYTE *)readAheadBuffer, blockNo * DISK_CACHE_BLOCK_SECTORS, blocksCount * DISK_CACHE_BLOCK_SECTORS);
   if (res != RES_OK) {
     return res;
   }
-  startSector = sector;
-  endSector = sector + DISK_CACHE_BLOCK_SECTORS;
-  memcpy(buff, data, count * BLOCK_SIZE);
-  TRACE_DISK_CACHE("\tcache %p FILLED from read(%u, %u)", this, (uint32_t)sector, (uint32_t)count);
+
+  for (UINT n=0; n<blocksCount; ++n) {
+    DiskCacheBlock * block = allocate(blockNo + n);
+    memcpy(block->data, (uint8_t *)readAheadBuffer + n * DISK_CACHE_BLOCK_SIZE, DISK_CACHE_BLOCK_SIZE);
+    block->validMask = DISK_CACHE_BLOCK_MASK;
+    block->readAhead = (n > 0);
+  }
+
+  TRACE_DISK_CACHE("\tcache FILLED with blocks %u-%u", (uint32_t)blockNo, (uint32_t)(blockNo + blocksCount - 1));
+  stats.noReadAheads += blocksCount - 1;
   return RES_OK;
 }
 
-void DiskCacheBlock::free(DWORD sector, UINT count) 
+// read the sectors of a partially written block which are not in the cache
+DRESULT DiskCache::complete(BYTE drv, DiskCacheBlock * block)
 {
-  if (sector < endSector && (sector+count) > startSector) {
-    TRACE_DISK_CACHE("\tINVALIDATING disk cache block %p (%u)", this, startSector);
-    endSector = 0;
+  DRESULT res = __disk_read(drv, (BYTE *)readAheadBuffer, block->blockNo * DISK_CACHE_BLOCK_SECTORS, DISK_CACHE_BLOCK_SECTORS);
+  if (res != RES_OK) {
+    return res;
   }
+
+  for (int n=0; n<DISK_CACHE_BLOCK_SECTORS; ++n) {
+    if (!(block->validMask & (1u << n))) {
+      memcpy(block->data + n * BLOCK_SIZE, (uint8_t *)readAheadBuffer + n * BLOCK_SIZE, BLOCK_SIZE);
+    }
+  }
+  block->validMask = DISK_CACHE_BLOCK_MASK;
+  return RES_OK;
 }
 
-void DiskCacheBlock::free()
+void DiskCache::setDirty(DiskCacheBlock * block, uint32_t mask)
 {
-  endSector = 0;
+  if (!block->dirtyMask) {
+    if (dirtyBlocks++ == 0) {
+      dirtyTime = get_tmr10ms();
+    }
+  }
+  block->dirtyMask |= mask;
 }
 
-bool DiskCacheBlock::empty() const
+void DiskCache::setClean(DiskCacheBlock * block, uint32_t mask)
 {
-  return (endSector == 0);
+  if (block->dirtyMask) {
+    block->dirtyMask &= ~mask;
+    if (!block->dirtyMask) {
+      --dirtyBlocks;
+    }
+  }
 }
 
-DiskCache::DiskCache():
-  lastBlock(0)
+// write each run of consecutive dirty sectors with one transfer
+DRESULT DiskCache::flushBlock(BYTE drv, DiskCacheBlock * block)
 {
-  stats.noHits = 0;
-  stats.noMisses = 0;
-  stats.noWrites = 0;
-  blocks = new DiskCacheBlock[DISK_CACHE_BLOCKS_NUM];
+  int n = 0;
+  while (n < DISK_CACHE_BLOCK_SECTORS) {
+    if (!(block->dirtyMask & (1u << n))) {
+      ++n;
+      continue;
+    }
+    int start = n;
+    while (n < DISK_CACHE_BLOCK_SECTORS && (block->dirtyMask & (1u << n))) {
+      ++n;
+    }
+    DRESULT res = __disk_write(drv, block->data + start * BLOCK_SIZE, block->blockNo * DISK_CACHE_BLOCK_SECTORS + start, n - start);
+    if (res != RES_OK) {
+      return res;
+    }
+    ++stats.noFlushes;
+    setClean(block, getSectorsMask(start, n - start));
+  }
+  return RES_OK;
 }
 
-void DiskCache::clear()
+// the dirty block written to the cache next after the given one, or first
+DiskCacheBlock * DiskCache::getNextDirty(const DiskCacheBlock * previous)
 {
-  lastBlock = 0;
-  stats.noHits = 0;
-  stats.noMisses = 0;
-  stats.noWrites = 0;
+  DiskCacheBlock * result = nullptr;
   for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
-    blocks[n].free();
+    DiskCacheBlock * block = &blocks[n];
+    if (block->dirtyMask && (!previous || block->lastWritten > previous->lastWritten) &&
+        (!result || block->lastWritten < result->lastWritten)) {
+      result = block;
+    }
   }
+  return result;
 }
 
-DRESULT DiskCache::read(BYTE drv, BYTE * buff, DWORD sector, UINT count)
+// Blocks are written in the order they were last written to the cache, so
+// that the FAT and directory sectors updated after some data never reach
+// the SD card before it. Consecutive fully dirty blocks (i.e. written
+// clusters) are coalesced in a single transfer as long as that order is kept
+DRESULT DiskCache::flushAll(BYTE drv)
+{
+  while (dirtyBlocks > 0) {
+    DiskCacheBlock * block = getNextDirty(nullptr);
+    if (!block) {
+      break;
+    }
+
+    DWORD blockNo = block->blockNo;
+    UINT blocksCount = 0;
+    for (DiskCacheBlock * next = block; next && next->dirtyMask == DISK_CACHE_BLOCK_MASK && blocksCount < DISK_CACHE_READ_AHEAD_MAX; ) {
+      memcpy((uint8_t *)readAheadBuffer + blocksCount * DISK_CACHE_BLOCK_SIZE, next->data, DISK_CACHE_BLOCK_SIZE);
+      ++blocksCount;
+      DiskCacheBlock * following = find(blockNo + blocksCount);
+      next = (following && following == getNextDirty(next)) ? following : nullptr;
+    }
+
+    if (blocksCount > 1) {
+      DRESULT res = __disk_write(drv, (BYTE *)readAheadBuffer, blockNo * DISK_CACHE_BLOCK_SECTORS, blocksCount * DISK_CACHE_BLOCK_SECTORS);
+      if (res != RES_OK) {
+        return res;
+      }
+      ++stats.noFlushes;
+      for (UINT n=0; n<blocksCount; ++n) {
+        setClean(find(blockNo + n), DISK_CACHE_BLOCK_MASK);
+      }
+    }
+    else {
+      DRESULT res = flushBlock(drv, block);
+      if (res != RES_OK) {
+        return res;
+      }
+    }
+  }
+
+  return RES_OK;
+}
+
+bool DiskCache::isFlushDue() const
+{
+  return dirtyBlocks > DISK_CACHE_DIRTY_MAX || (dirtyBlocks > 0 && (tmr10ms_t)(get_tmr10ms() - dirtyTime) >= DISK_CACHE_FLUSH_DELAY);
+}
+
+void DiskCache::flush()
+{
+  if (dirtyBlocks > 0) {
+    ff_req_grant(g_FATFS_Obj.sobj);
+    if (flushAll(0) != RES_OK) {
+      TRACE("disk cache: flush failed");
+    }
+    ff_rel_grant(g_FATFS_Obj.sobj);
+  }
+}
+
+DRESULT DiskCache::sync(BYTE drv)
+{
+  DRESULT res = flushAll(drv);
+  if (res != RES_OK) {
+    TRACE("disk cache: sync failed");
+  }
+  return res;
+}
+
+void DiskCache::checkFlush()
+{
+  if (isFlushDue()) {
+    flush();
+  }
+}
+
+// copy the dirty sectors over data read directly from the SD card
+static void patchDirtySectors(DiskCacheBlock * block, BYTE * buff, DWORD sector, UINT count)
 {
-  // TODO: check if not caching first sectors would improve anything
-  // if (sector < 1000) {
-  //   ++stats.noMisses;
-  //   return __disk_read(drv, buff, sector, count);  
-  // }
+  for (DWORD s = max<DWORD>(sector, block->blockNo * DISK_CACHE_BLOCK_SECTORS); s < sector + count && s < (block->blockNo + 1) * DISK_CACHE_BLOCK_SECTORS; ++s) {
+    if (block->dirtyMask & (1u << (s % DISK_CACHE_BLOCK_SECTORS))) {
+      block->read(buff + (s - sector) * BLOCK_SIZE, s, 1);
+    }
+  }
+}
 
+DRESULT DiskCache::read(BYTE drv, BYTE * buff, DWORD sector, UINT count)
+{
   // if read is bigger than cache block, then read it directly without using cache
   if (count > DISK_CACHE_BLOCK_SECTORS) {
     TRACE_DISK_CACHE("\t\t big read(%u, %u)",  (uint32_t)sector, (uint32_t)count);
-    return __disk_read(drv, buff, sector, count);
+    DRESULT res = __disk_read(drv, buff, sector, count);
+    if (res == RES_OK && dirtyBlocks > 0) {
+      for (DWORD blockNo = sector / DISK_CACHE_BLOCK_SECTORS; blockNo <= (sector + count - 1) / DISK_CACHE_BLOCK_SECTORS; ++blockNo) {
+        DiskCacheBlock * block = find(blockNo);
+        if (block && block->dirtyMask) {
+          patchDirtySectors(block, buff, sector, count);
+        }
+      }
+    }
+    return res;
   }
-  
-  // if block + cache block size is beyond the end of the disk, then read it directly without using cache
-  if (sector+DISK_CACHE_BLOCK_SECTORS >= sdGetNoSectors()) {
+
+  // if the last cache block is beyond the end of the disk, then read it directly without using cache
+  DWORD noBlocks = sdGetNoSectors() / DISK_CACHE_BLOCK_SECTORS;
+  if ((sector + count - 1) / DISK_CACHE_BLOCK_SECTORS >= noBlocks) {
     TRACE_DISK_CACHE("\t\t cache would be beyond end of disk %u (%u)", (uint32_t)sector, sdGetNoSectors());
     return __disk_read(drv, buff, sector, count);
   }
 
-  for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
-    if (blocks[n].read(buff, sector, count)) {
+  int streamIndex = getStream(sector, count);
+  DiskCacheStream & stream = streams[streamIndex];
+  DiskCacheStreamStats & streamStats = stats.streams[streamIndex];
+
+  // a read may span two blocks
+  while (count > 0) {
+    DWORD blockNo = sector / DISK_CACHE_BLOCK_SECTORS;
+    UINT n = min<UINT>(count, DISK_CACHE_BLOCK_SECTORS - (sector % DISK_CACHE_BLOCK_SECTORS));
+
+    DiskCacheBlock * block = find(blockNo);
+    if (block && block->contains(sector, n)) {
       ++stats.noHits;
-      return RES_OK;
+      ++streamStats.noHits;
+      if (block->readAhead) {
+        ++stats.noReadAheadHits;
+        block->readAhead = false;
+      }
+      block->lastUsed = ++clock;
     }
-  }
+    else if (block) {
+      // partially written block
+      ++stats.noMisses;
+      ++streamStats.noMisses;
+      DRESULT res = complete(drv, block);
+      if (res != RES_OK) {
+        return res;
+      }
+      block->lastUsed = ++clock;
+    }
+    else {
+      ++stats.noMisses;
+      ++streamStats.noMisses;
 
-  ++stats.noMisses;
+      // read the next blocks of a sequential stream as well, unless already cached
+      UINT blocksCount = 1;
+      while (blocksCount < stream.readAhead && blockNo + blocksCount < noBlocks && !find(blockNo + blocksCount)) {
+        ++blocksCount;
+      }
 
-  // find free block
-  for (int n=0; n<DISK_CACHE_BLOCKS_NUM; ++n) {
-    if (blocks[n].empty()) {
-      TRACE_DISK_CACHE("\t\t using free block");
-      return blocks[n].fill(drv, buff, sector, count);
+      DRESULT res = fill(drv, blockNo, blocksCount);
+      if (res != RES_OK) {
+        return res;
+      }
+
+      if (blocksCount > 1) {
+        streamStats.noReadAheads += blocksCount - 1;
+        // the stream keeps consuming what is read ahead, read more next time
+        stream.readAhead = min<uint8_t>(stream.readAhead * 2, DISK_CACHE_READ_AHEAD_MAX);
+      }
+
+      block = find(blockNo);
     }
-  }
 
-  // use next block (round robin)
-  // TODO: use better strategy to select which used block gets used here
-  if (++lastBlock >= DISK_CACHE_BLOCKS_NUM) {
-    lastBlock = 0;
+    block->read(buff, sector, n);
+    buff += n * BLOCK_SIZE;
+    sector += n;
+    count -= n;
   }
-  
-  return blocks[lastBlock].fill(drv, buff, sector, count);
+
+  return RES_OK;
 }
 
+// Writes up to one block are only done in the cache, and written to the
+// SD card later by flush(), once DISK_CACHE_DIRTY_MAX blocks are dirty or
+// after DISK_CACHE_FLUSH_DELAY. Bigger writes go directly to the SD card.
 DRESULT DiskCache::write(BYTE drv, const BYTE* buff, DWORD sector, UINT count)
 {
   ++stats.noWrites;
-  for(int n=0; n < DISK_CACHE_BLOCKS_NUM; ++n) {
-    blocks[n].free(sector, count);
+
+  DWORD noBlocks = sdGetNoSectors() / DISK_CACHE_BLOCK_SECTORS;
+  if (count > DISK_CACHE_BLOCK_SECTORS || (sector + count - 1) / DISK_CACHE_BLOCK_SECTORS >= noBlocks) {
+    // keep the cached blocks up to date
+    for (DWORD blockNo = sector / DISK_CACHE_BLOCK_SECTORS; blockNo <= (sector + count - 1) / DISK_CACHE_BLOCK_SECTORS; ++blockNo) {
+      DiskCacheBlock * block = find(blockNo);
+      if (block) {
+        DWORD start = max<DWORD>(sector, blockNo * DISK_CACHE_BLOCK_SECTORS);
+        DWORD end = min<DWORD>(sector + count, (blockNo + 1) * DISK_CACHE_BLOCK_SECTORS);
+        memcpy(block->data + (start % DISK_CACHE_BLOCK_SECTORS) * BLOCK_SIZE, buff + (start - sector) * BLOCK_SIZE, (end - start) * BLOCK_SIZE);
+        uint32_t mask = getSectorsMask(start, end - start);
+        block->validMask |= mask;
+        setClean(block, mask);
+      }
+    }
+    return __disk_write(drv, buff, sector, count);
   }
-  return __disk_write(drv, buff, sector, count);  
+
+  while (count > 0) {
+    DWORD blockNo = sector / DISK_CACHE_BLOCK_SECTORS;
+    UINT n = min<UINT>(count, DISK_CACHE_BLOCK_SECTORS - (sector % DISK_CACHE_BLOCK_SECTORS));
+
+    DiskCacheBlock * block = find(blockNo);
+    if (!block) {
+      block = allocate(blockNo);
+    }
+
+    TRACE_DISK_CACHE("\tcache write(%u, %u) to %p", (uint32_t)sector, (uint32_t)n, block);
+    memcpy(block->data + (sector % DISK_CACHE_BLOCK_SECTORS) * BLOCK_SIZE, buff, n * BLOCK_SIZE);
+    uint32_t mask = getSectorsMask(sector, n);
+    block->validMask |= mask;
+    block->readAhead = false;
+    block->lastUsed = ++clock;
+    block->lastWritten = clock;
+    setDirty(block, mask);
+
+    buff += n * BLOCK_SIZE;
+    sector += n;
+    count -= n;
+  }
+
+  if (isFlushDue()) {
+    return flushAll(drv);
+  }
+
+  return RES_OK;
 }
 
-const DiskCacheStats & DiskCache::getStats() const 
-{ 
-  return stats; 
+const DiskCacheStats & DiskCache::getStats() const
+{
+  return stats;
 }
 
 int DiskCache::getHitRate() const
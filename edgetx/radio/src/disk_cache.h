@@ -28,23 +28,45 @@
 // tunable parameters
 #define DISK_CACHE_BLOCKS_NUM      32   // no cache blocks
 #define DISK_CACHE_BLOCK_SECTORS   16   // no sectors
+#define DISK_CACHE_HASH_SIZE       64   // no hash buckets (power of 2)
+#define DISK_CACHE_STREAMS         4    // no sequential streams tracked
+#define DISK_CACHE_READ_AHEAD_MAX  4    // max no blocks read or written at once
+#define DISK_CACHE_DIRTY_MAX       8    // max no dirty blocks before flushing
+#define DISK_CACHE_FLUSH_DELAY     100  // max time data stays dirty (10ms units)
 
 #define DISK_CACHE_BLOCK_SIZE   (DISK_CACHE_BLOCK_SECTORS * BLOCK_SIZE)
+#define DISK_CACHE_BLOCK_MASK   (uint32_t)((1ull << DISK_CACHE_BLOCK_SECTORS) - 1)
 
+// Blocks are aligned on DISK_CACHE_BLOCK_SECTORS boundaries, so that a given
+// sector can only be in one block, found through a hash of its block number.
+// Each sector of a block may be valid (same data as on the SD card or newer)
+// and dirty (written to the cache, not to the SD card yet).
 class DiskCacheBlock
 {
 public:
   DiskCacheBlock();
-  bool read(BYTE* buff, DWORD sector, UINT count);
-  DRESULT fill(BYTE drv, BYTE* buff, DWORD sector, UINT count);
-  void free(DWORD sector, UINT count);
+  bool contains(DWORD sector, UINT count) const;
+  void read(BYTE* buff, DWORD sector, UINT count) const;
   void free();
   bool empty() const;
 
-private:
   uint8_t data[DISK_CACHE_BLOCK_SIZE];
+  DWORD blockNo;
+  uint32_t lastUsed;
+  uint32_t lastWritten;  // flushing order
+  uint32_t validMask;
+  uint32_t dirtyMask;
+  int8_t next;          // next block in the same hash bucket
+  bool readAhead;       // filled by read-ahead, not read yet
+};
+
+struct DiskCacheStreamStats
+{
   DWORD startSector;
-  DWORD endSector;
+  uint32_t noReads;
+  uint32_t noHits;
+  uint32_t noMisses;
+  uint32_t noReadAheads;
 };
 
 struct DiskCacheStats
@@ -52,6 +74,19 @@ struct DiskCacheStats
   uint32_t noHits;
   uint32_t noMisses;
   uint32_t noWrites;
+  uint32_t noFlushes;
+  uint32_t noReadAheads;
+  uint32_t noReadAheadHits;
+  DiskCacheStreamStats streams[DISK_CACHE_STREAMS];
+};
+
+// A sequential reader (WAV file, Lua script, YAML file, ...)
+struct DiskCacheStream
+{
+  DWORD nextSector;
+  uint32_t lastUsed;
+  uint8_t sequentialReads;
+  uint8_t readAhead;    // no blocks read on next miss
 };
 
 class DiskCache
@@ -62,12 +97,37 @@ class DiskCache
     DRESULT write(BYTE drv, const BYTE* buff, DWORD sector, UINT count);
     const DiskCacheStats & getStats() const;
     int getHitRate() const;
+    // dirty data is lost, flush() first if needed
     void clear();
+    // write all dirty data to the SD card
+    void flush();
+    // same, only if some data has been dirty for DISK_CACHE_FLUSH_DELAY
+    void checkFlush();
+    // same as flush(), for disk_ioctl(CTRL_SYNC), FatFs being already locked
+    DRESULT sync(BYTE drv);
 
   private:
     DiskCacheStats stats;
-    uint32_t lastBlock;
+    uint32_t clock;
+    uint8_t dirtyBlocks;
+    tmr10ms_t dirtyTime;
     DiskCacheBlock * blocks;
+    uint32_t * readAheadBuffer;
+    int8_t hashTable[DISK_CACHE_HASH_SIZE];
+    DiskCacheStream streams[DISK_CACHE_STREAMS];
+
+    DiskCacheBlock * find(DWORD blockNo);
+    DiskCacheBlock * allocate(DWORD blockNo);
+    void unlink(DiskCacheBlock * block);
+    int getStream(DWORD sector, UINT count);
+    DRESULT fill(BYTE drv, DWORD blockNo, UINT blocksCount);
+    DRESULT complete(BYTE drv, DiskCacheBlock * block);
+    void setDirty(DiskCacheBlock * block, uint32_t mask);
+    void setClean(DiskCacheBlock * block, uint32_t mask);
+    DiskCacheBlock * getNextDirty(const DiskCacheBlock * previous);
+    DRESULT flushBlock(BYTE drv, DiskCacheBlock * block);
+    DRESULT flushAll(BYTE drv);
+    bool isFlushDue() const;
 };
 
 extern DiskCache diskCache;
@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "opentx.h"
+#include "event_trace.h"
+
+struct EventTraceRecord
+{
+  uint16_t time;     // 2MHz timer
+  uint8_t type;
+  uint8_t id;
+  uint32_t arg;
+};
+
+static_assert(sizeof(EventTraceRecord) == 8, "Event trace records must be 8 bytes");
+static_assert((EVENT_TRACE_BUFFER_SIZE & (EVENT_TRACE_BUFFER_SIZE - 1)) == 0, "EVENT_TRACE_BUFFER_SIZE must be a power of 2");
+
+static EventTraceRecord eventTraceBuffer[EVENT_TRACE_BUFFER_SIZE];
+static volatile uint32_t eventTraceHead;   // next slot to reserve
+static volatile uint32_t eventTraceTail;   // next slot to stream
+static volatile uint32_t eventTraceDropped;
+static volatile uint8_t eventTraceOutput = EVENT_TRACE_OUTPUT_NONE;
+// the interrupts of the output would mostly trace the trace itself
+static uint8_t eventTraceIgnoredIsr = 0xFF;
+
+static char eventTraceTaskNames[EVENT_TRACE_MAX_TASKS][configMAX_TASK_NAME_LEN];
+
+// Returns the reserved slot, or nullptr if the buffer is full
+static EventTraceRecord * eventTraceReserve()
+{
+  // an interrupt between LDREX and STREX makes STREX fail: the timestamp
+  // is taken again, so that the records stay in time order
+  uint32_t index;
+  uint16_t time;
+  do {
+    index = __LDREXW((uint32_t *)&eventTraceHead);
+    if (index - eventTraceTail >= EVENT_TRACE_BUFFER_SIZE) {
+      __CLREX();
+      eventTraceDropped++;
+      return nullptr;
+    }
+    time = getTmr2MHz();
+  } while (__STREXW(index + 1, (uint32_t *)&eventTraceHead));
+
+  EventTraceRecord * record = &eventTraceBuffer[index & (EVENT_TRACE_BUFFER_SIZE - 1)];
+  record->time = time;
+  return record;
+}
+
+static void eventTraceCommit(EventTraceRecord * record, uint8_t type)
+{
+  __DMB();
+  record->type = type;
+}
+
+void eventTraceRecord(uint8_t type, uint8_t id, uint32_t arg)
+{
+  if (eventTraceOutput == EVENT_TRACE_OUTPUT_NONE)
+    return;
+
+  if (id == eventTraceIgnoredIsr && (type == EVENT_TRACE_TYPE_ISR_ENTER || type == EVENT_TRACE_TYPE_ISR_EXIT))
+    return;
+
+  EventTraceRecord * record = eventTraceReserve();
+  if (record) {
+    record->id = id;
+    record->arg = arg;
+    eventTraceCommit(record, type);
+  }
+}
+
+void eventTraceTaskCreate(uint32_t task, const char * name)
+{
+  if (task < EVENT_TRACE_MAX_TASKS) {
+    strncpy(eventTraceTaskNames[task], name, configMAX_TASK_NAME_LEN);
+  }
+}
+
+void eventTraceTaskSwitchedIn(uint32_t task)
+{
+  eventTraceRecord(EVENT_TRACE_TYPE_TASK_SWITCH, task, 0);
+}
+
+void eventTraceTick(uint32_t ticks)
+{
+  // the host needs at least one event per 2MHz timer wrap
+  if ((ticks % EVENT_TRACE_TICK_INTERVAL) == 0) {
+    eventTraceRecord(EVENT_TRACE_TYPE_TICK, 0, ticks);
+  }
+}
+
+static void eventTraceRecordTaskNames()
+{
+  for (uint8_t task = 0; task < EVENT_TRACE_MAX_TASKS; task++) {
+    const char * name = eventTraceTaskNames[task];
+    for (uint8_t offset = 0; offset < configMAX_TASK_NAME_LEN && name[offset]; offset += 4) {
+      EventTraceRecord * record = eventTraceReserve();
+      if (!record)
+        return;
+      uint32_t chars = 0;
+      memcpy(&chars, &name[offset], min<uint8_t>(4, configMAX_TASK_NAME_LEN - offset));
+      record->time = offset; // names are not timed
+      record->id = task;
+      record->arg = chars;
+      eventTraceCommit(record, EVENT_TRACE_TYPE_TASK_NAME);
+    }
+  }
+}
+
+// Returns the next complete record, or nullptr
+static EventTraceRecord * eventTracePeek()
+{
+  if (eventTraceTail == eventTraceHead)
+    return nullptr;
+
+  EventTraceRecord * record = &eventTraceBuffer[eventTraceTail & (EVENT_TRACE_BUFFER_SIZE - 1)];
+  if (record->type == EVENT_TRACE_TYPE_NONE)
+    return nullptr; // still being written
+  __DMB();
+  return record;
+}
+
+static void eventTraceConsume(EventTraceRecord * record)
+{
+  // the slot must be free before it can be reserved again
+  record->type = EVENT_TRACE_TYPE_NONE;
+  __DMB();
+  eventTraceTail = eventTraceTail + 1;
+}
+
+void eventTraceStart(uint8_t output)
+{
+  eventTraceOutput = EVENT_TRACE_OUTPUT_NONE;
+
+  // drop what remains from a previous trace
+  EventTraceRecord * record;
+  while ((record = eventTracePeek())) {
+    eventTraceConsume(record);
+  }
+  eventTraceDropped = 0;
+
+  if (output == EVENT_TRACE_OUTPUT_USB)
+    eventTraceIgnoredIsr = EVENT_TRACE_ISR_USB;
+  else if (output == EVENT_TRACE_OUTPUT_AUX)
+    eventTraceIgnoredIsr = EVENT_TRACE_ISR_AUX_SERIAL;
+  else
+    eventTraceIgnoredIsr = 0xFF;
+
+  eventTraceOutput = output;
+  if (output != EVENT_TRACE_OUTPUT_NONE) {
+    eventTraceRecordTaskNames();
+    eventTraceRecord(EVENT_TRACE_TYPE_TICK, 0, RTOS_GET_TIME());
+  }
+}
+
+void eventTraceStop()
+{
+  eventTraceOutput = EVENT_TRACE_OUTPUT_NONE;
+}
+
+uint8_t eventTraceGetOutput()
+{
+  return eventTraceOutput;
+}
+
+static uint32_t eventTraceOutputSpace(uint8_t output)
+{
+#if defined(USB_SERIAL)
+  if (output == EVENT_TRACE_OUTPUT_USB && getSelectedUsbMode() == USB_SERIAL_MODE)
+    return usbSerialFreeSpace();
+#endif
+#if defined(AUX_SERIAL)
+  if (output == EVENT_TRACE_OUTPUT_AUX && auxSerialTracesEnabled())
+    return AUX_SERIAL_TX_FIFO_SIZE - 1 - auxSerialTxFifo.size();
+#endif
+  return 0;
+}
+
+static void eventTraceOutputWrite(uint8_t output, const uint8_t * data, uint32_t len)
+{
+#if defined(USB_SERIAL)
+  if (output == EVENT_TRACE_OUTPUT_USB) {
+    usbSerialWrite(data, len);
+    return;
+  }
+#endif
+#if defined(AUX_SERIAL)
+  if (output == EVENT_TRACE_OUTPUT_AUX) {
+    for (uint32_t i = 0; i < len; i++) {
+      auxSerialPutc(data[i]);
+    }
+  }
+#endif
+}
+
+void eventTraceFlush()
+{
+  uint8_t output = eventTraceOutput;
+  if (output == EVENT_TRACE_OUTPUT_NONE)
+    return;
+
+  uint8_t packet[4 + EVENT_TRACE_PACKET_RECORDS * sizeof(EventTraceRecord)];
+
+  while (true) {
+    // only whole packets are written, the records stay in the buffer otherwise
+    uint32_t space = eventTraceOutputSpace(output);
+    if (space < 4 + sizeof(EventTraceRecord))
+      return;
+    uint32_t maxRecords = min<uint32_t>(EVENT_TRACE_PACKET_RECORDS, (space - 4) / sizeof(EventTraceRecord));
+
+    uint8_t count = 0;
+    EventTraceRecord * record;
+    while (count < maxRecords && (record = eventTracePeek())) {
+      memcpy(&packet[4 + count * sizeof(EventTraceRecord)], record, sizeof(EventTraceRecord));
+      eventTraceConsume(record);
+      count++;
+    }
+    if (count == 0)
+      return;
+
+    uint32_t dropped = eventTraceDropped;
+    eventTraceDropped = 0;
+
+    packet[0] = EVENT_TRACE_SYNC1;
+    packet[1] = EVENT_TRACE_SYNC2;
+    packet[2] = count;
+    packet[3] = min<uint32_t>(dropped, 255);
+    eventTraceOutputWrite(output, packet, 4 + count * sizeof(EventTraceRecord));
+  }
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Binary trace of the task switches, interrupts and code sections
+//
+// Events are 8 byte records timestamped with the 2MHz timer. They are
+// written to a ring buffer from any context (tasks or interrupts) without
+// locking: the slot is reserved with LDREX/STREX, and the record is marked
+// as complete by writing its type last. eventTraceFlush() streams the
+// complete records in packets:
+//   0xA5, 0x5A, records count, dropped records count, records
+// radio/util/event_trace2json.py converts the stream to a Chrome / Perfetto
+// JSON trace.
+
+#if !defined(EVENT_TRACE_BUFFER_SIZE)
+  #define EVENT_TRACE_BUFFER_SIZE      1024 // records, power of 2
+#endif
+
+#define EVENT_TRACE_SYNC1              0xA5
+#define EVENT_TRACE_SYNC2              0x5A
+#define EVENT_TRACE_PACKET_RECORDS     32
+#define EVENT_TRACE_MAX_TASKS          8
+#define EVENT_TRACE_TICK_INTERVAL      16   // ticks, below the 2MHz timer wrap (32ms)
+
+enum EventTraceType {
+  EVENT_TRACE_TYPE_NONE,               // slot reserved, record not written yet
+  EVENT_TRACE_TYPE_TICK,               // arg: RTOS tick count
+  EVENT_TRACE_TYPE_TASK_NAME,          // id: task, time: offset in the name, arg: 4 chars
+  EVENT_TRACE_TYPE_TASK_SWITCH,        // id: task switched in
+  EVENT_TRACE_TYPE_ISR_ENTER,          // id: EventTraceIsr
+  EVENT_TRACE_TYPE_ISR_EXIT,
+  EVENT_TRACE_TYPE_BEGIN,              // id: EventTraceSection, arg: optional value
+  EVENT_TRACE_TYPE_END,
+};
+
+enum EventTraceIsr {
+  EVENT_TRACE_ISR_INTMODULE,
+  EVENT_TRACE_ISR_EXTMODULE,
+  EVENT_TRACE_ISR_TELEMETRY,
+  EVENT_TRACE_ISR_AUX_SERIAL,
+  EVENT_TRACE_ISR_TRAINER,
+  EVENT_TRACE_ISR_USB,
+  EVENT_TRACE_ISR_SDIO,
+  EVENT_TRACE_ISR_AUDIO,
+};
+
+enum EventTraceSection {
+  EVENT_TRACE_MIXER,
+  EVENT_TRACE_TELEMETRY,
+  EVENT_TRACE_PER_MAIN,
+  EVENT_TRACE_LUA,
+  EVENT_TRACE_SD_READ,                 // arg: sector
+  EVENT_TRACE_SD_WRITE,                // arg: sector
+};
+
+enum EventTraceOutput {
+  EVENT_TRACE_OUTPUT_NONE,
+  EVENT_TRACE_OUTPUT_USB,
+  EVENT_TRACE_OUTPUT_AUX,
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+void eventTraceRecord(uint8_t type, uint8_t id, uint32_t arg);
+
+// FreeRTOS hooks
+void eventTraceTaskCreate(uint32_t task, const char * name);
+void eventTraceTaskSwitchedIn(uint32_t task);
+void eventTraceTick(uint32_t ticks);
+
+#if defined(__cplusplus)
+}
+
+void eventTraceStart(uint8_t output);
+void eventTraceStop();
+uint8_t eventTraceGetOutput();
+// streams the complete records, as much as the output can take
+void eventTraceFlush();
+
+class EventTraceIsrScope
+{
+  public:
+    explicit EventTraceIsrScope(uint8_t isr): isr(isr)
+    {
+      eventTraceRecord(EVENT_TRACE_TYPE_ISR_ENTER, isr, 0);
+    }
+
+    ~EventTraceIsrScope()
+    {
+      eventTraceRecord(EVENT_TRACE_TYPE_ISR_EXIT, isr, 0);
+    }
+
+  protected:
+    uint8_t isr;
+};
+#endif
+
+#if defined(EVENT_TRACE)
+  #define EVENT_TRACE_BEGIN(section, arg)  eventTraceRecord(EVENT_TRACE_TYPE_BEGIN, section, arg)
+  #define EVENT_TRACE_END(section)         eventTraceRecord(EVENT_TRACE_TYPE_END, section, 0)
+  #define EVENT_TRACE_ISR_ENTER(isr)       eventTraceRecord(EVENT_TRACE_TYPE_ISR_ENTER, isr, 0)
+  #define EVENT_TRACE_ISR_EXIT(isr)        eventTraceRecord(EVENT_TRACE_TYPE_ISR_EXIT, isr, 0)
+  // whole C++ interrupt handler
+  #define EVENT_TRACE_ISR(isr)             EventTraceIsrScope eventTraceIsrScope(isr)
+#else
+  #define EVENT_TRACE_BEGIN(section, arg)
+  #define EVENT_TRACE_END(section)
+  #define EVENT_TRACE_ISR_ENTER(isr)
+  #define EVENT_TRACE_ISR_EXIT(isr)
+  #define EVENT_TRACE_ISR(isr)
+#endif
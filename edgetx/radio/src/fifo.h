@@ -55,6 +55,36 @@ class Fifo
       ridx = nextIndex(ridx);
     }
 
+    // returns the number of elements pushed, limited by the free space
+    uint32_t push(const T * elements, uint32_t count)
+    {
+      uint32_t w = widx;
+      uint32_t free = N - 1 - ((N + w - ridx) & (N - 1));
+      if (count > free)
+        count = free;
+      for (uint32_t i = 0; i < count; i++) {
+        fifo[w] = elements[i];
+        w = nextIndex(w);
+      }
+      widx = w;
+      return count;
+    }
+
+    // returns the number of elements popped
+    uint32_t pop(T * elements, uint32_t count)
+    {
+      uint32_t r = ridx;
+      uint32_t available = (N + widx - r) & (N - 1);
+      if (count > available)
+        count = available;
+      for (uint32_t i = 0; i < count; i++) {
+        elements[i] = fifo[r];
+        r = nextIndex(r);
+      }
+      ridx = r;
+      return count;
+    }
+
     bool pop(T & element)
     {
       if (isEmpty()) {
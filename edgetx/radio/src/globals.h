@@ -44,6 +44,12 @@ extern uint16_t s_timeCum16ThrP;
 #if defined(OVERRIDE_CHANNEL_FUNCTION)
 #define OVERRIDE_CHANNEL_UNDEFINED -4096
 extern safetych_t safetyCh[MAX_OUTPUT_CHANNELS];
+
+// Channel values (-1024..1024) set at runtime (external control, Lua).
+// Like the GVars runtime values they are never saved
+void setChannelRuntimeValues(uint8_t first, const int16_t * values, uint8_t count);
+void clearChannelRuntimeValues();
+bool isChannelRuntimeValue(uint8_t channel);
 #endif
 
 extern uint8_t trimsCheckTimer;
@@ -110,7 +110,7 @@ void menuChannelsViewCommon(event_t event)
     if (!reusableBuffer.viewChannels.mixersView) {
       // Properties
 #if defined(OVERRIDE_CHANNEL_FUNCTION)
-      if (safetyCh[ch] != OVERRIDE_CHANNEL_UNDEFINED)
+      if (safetyCh[ch] != OVERRIDE_CHANNEL_UNDEFINED || isChannelRuntimeValue(ch))
         lcdDrawText(CHANNEL_PROPERTIES_OFFSET, y, "OVR", TINSIZE);
       else
 #endif
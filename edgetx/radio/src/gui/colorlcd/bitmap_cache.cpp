@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <list>
+#include <string>
+
+#include "opentx.h"
+#include "bitmap_cache.h"
+
+struct BitmapCacheEntry
+{
+  std::string path;
+  WORD fdate;
+  WORD ftime;
+  BitmapBuffer * bitmap;
+  uint32_t size;
+  uint16_t refs;
+  bool stale;   // file changed on SD, freed as soon as it is released
+};
+
+// most recently used first
+static std::list<BitmapCacheEntry> bitmapCache;
+static BitmapCacheStats bitmapCacheStats;
+
+static void bitmapCacheErase(std::list<BitmapCacheEntry>::iterator it)
+{
+  bitmapCacheStats.size -= it->size;
+  bitmapCacheStats.count--;
+  delete it->bitmap;
+  bitmapCache.erase(it);
+}
+
+static void bitmapCacheShrink(uint32_t budget)
+{
+  uint32_t unused = 0;
+  for (auto & entry: bitmapCache) {
+    if (entry.refs == 0)
+      unused += entry.size;
+  }
+
+  auto it = bitmapCache.end();
+  while (unused > budget && it != bitmapCache.begin()) {
+    --it;
+    if (it->refs == 0) {
+      unused -= it->size;
+      TRACE("bitmapCache: evict %s (%u)", it->path.c_str(), it->size);
+      bitmapCacheErase(it++);
+    }
+  }
+}
+
+const BitmapBuffer * bitmapCacheLoad(const char * path)
+{
+  FILINFO info;
+  if (f_stat(path, &info) != FR_OK) {
+    return nullptr;
+  }
+
+  for (auto it = bitmapCache.begin(); it != bitmapCache.end(); ++it) {
+    if (it->stale || it->path != path)
+      continue;
+
+    if (it->fdate == info.fdate && it->ftime == info.ftime) {
+      it->refs++;
+      bitmapCacheStats.hits++;
+      bitmapCache.splice(bitmapCache.begin(), bitmapCache, it);
+      return it->bitmap;
+    }
+
+    // the file has been modified since it was loaded
+    if (it->refs == 0)
+      bitmapCacheErase(it);
+    else
+      it->stale = true;
+    break;
+  }
+
+  bitmapCacheStats.misses++;
+
+  BitmapBuffer * bitmap = BitmapBuffer::loadBitmap(path);
+  if (!bitmap) {
+    // retry once without the unused bitmaps
+    bitmapCacheShrink(0);
+    bitmap = BitmapBuffer::loadBitmap(path);
+    if (!bitmap)
+      return nullptr;
+  }
+
+  BitmapCacheEntry entry;
+  entry.path = path;
+  entry.fdate = info.fdate;
+  entry.ftime = info.ftime;
+  entry.bitmap = bitmap;
+  entry.size = bitmap->getDataSize();
+  entry.refs = 1;
+  entry.stale = false;
+  bitmapCache.push_front(entry);
+
+  bitmapCacheStats.size += entry.size;
+  bitmapCacheStats.count++;
+
+  bitmapCacheShrink(BITMAP_CACHE_BUDGET);
+
+  return bitmap;
+}
+
+void bitmapCacheRelease(const BitmapBuffer * bitmap)
+{
+  if (!bitmap)
+    return;
+
+  for (auto it = bitmapCache.begin(); it != bitmapCache.end(); ++it) {
+    if (it->bitmap == bitmap) {
+      if (it->refs > 0)
+        it->refs--;
+      if (it->refs == 0) {
+        if (it->stale)
+          bitmapCacheErase(it);
+        else
+          bitmapCacheShrink(BITMAP_CACHE_BUDGET);
+      }
+      return;
+    }
+  }
+
+  TRACE("bitmapCache: release of unknown bitmap %p", bitmap);
+}
+
+void bitmapCacheFlush()
+{
+  bitmapCacheShrink(0);
+}
+
+const BitmapCacheStats & bitmapCacheGetStats()
+{
+  return bitmapCacheStats;
+}
+
+void bitmapCacheResetStats()
+{
+  bitmapCacheStats.hits = 0;
+  bitmapCacheStats.misses = 0;
+}
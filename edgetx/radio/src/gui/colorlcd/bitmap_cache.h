@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#pragma once
+
+#include "bitmapbuffer.h"
+
+// Decoded bitmaps loaded from the SD card, shared between the UI and Lua.
+//
+// Bitmaps are looked up by path and modification time, and reference
+// counted. Released bitmaps stay decoded (in the heap, which lives in
+// SDRAM) until the unused ones exceed the budget, then the least recently
+// used ones are freed first.
+
+#if !defined(BITMAP_CACHE_BUDGET)
+  #define BITMAP_CACHE_BUDGET          (2 * 1024 * 1024)
+#endif
+
+struct BitmapCacheStats
+{
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t size;
+  uint16_t count;
+};
+
+// Returns a new reference, or nullptr if the file can't be loaded
+const BitmapBuffer * bitmapCacheLoad(const char * path);
+void bitmapCacheRelease(const BitmapBuffer * bitmap);
+
+// Frees all the unused bitmaps
+void bitmapCacheFlush();
+
+const BitmapCacheStats & bitmapCacheGetStats();
+void bitmapCacheResetStats();
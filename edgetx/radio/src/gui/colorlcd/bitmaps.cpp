@@ -193,16 +193,16 @@ const uint8_t LBM_SWIPE_RIGHT[] = {
   #include "mask_swipe_right.lbm"
 };
 
-BitmapBuffer * calibStick = nullptr;
-BitmapBuffer * calibStickBackground = nullptr;
-BitmapBuffer * calibTrackpBackground = nullptr;
+const BitmapBuffer * calibStick = nullptr;
+const BitmapBuffer * calibStickBackground = nullptr;
+const BitmapBuffer * calibTrackpBackground = nullptr;
 //BitmapBuffer * modelselIconBitmap = nullptr;
 BitmapBuffer * modelselSdFreeBitmap = nullptr;
 BitmapBuffer * modelselModelQtyBitmap = nullptr;
 BitmapBuffer * modelselModelNameBitmap = nullptr;
 BitmapBuffer * modelselModelMoveBackground = nullptr;
 BitmapBuffer * modelselModelMoveIcon = nullptr;
-BitmapBuffer * modelselWizardBackground = nullptr;
+const BitmapBuffer * modelselWizardBackground = nullptr;
 BitmapBuffer * chanMonLockedBitmap = nullptr;
 BitmapBuffer * chanMonInvertedBitmap = nullptr;
 BitmapBuffer * mixerSetupMixerBitmap = nullptr;
@@ -81,12 +81,12 @@ extern BitmapBuffer * modelselModelQtyBitmap;
 extern BitmapBuffer * modelselModelNameBitmap;
 extern BitmapBuffer * modelselModelMoveBackground;
 extern BitmapBuffer * modelselModelMoveIcon;
-extern BitmapBuffer * modelselWizardBackground;
+extern const BitmapBuffer * modelselWizardBackground;
 
 // calibration bitmaps
-extern BitmapBuffer * calibStick;
-extern BitmapBuffer * calibStickBackground;
-extern BitmapBuffer * calibTrackpBackground;
+extern const BitmapBuffer * calibStick;
+extern const BitmapBuffer * calibStickBackground;
+extern const BitmapBuffer * calibTrackpBackground;
 
 // Channels monitor bitmaps
 extern BitmapBuffer * chanMonLockedBitmap;
@@ -294,7 +294,7 @@ class ComboChannelBar : public ChannelBar
 
       // Override icon
 #if defined(OVERRIDE_CHANNEL_FUNCTION)
-      if (safetyCh[channel] != OVERRIDE_CHANNEL_UNDEFINED)
+      if (safetyCh[channel] != OVERRIDE_CHANNEL_UNDEFINED || isChannelRuntimeValue(channel))
         dc->drawMask(0, 1, chanMonLockedBitmap, textColor);
 #endif
 
@@ -320,6 +320,11 @@ class ComboChannelBar : public ChannelBar
         safetyChValue = newSafetyChValue;
         invalidate();
       }
+      bool newRuntimeValue = isChannelRuntimeValue(channel);
+      if (runtimeValue != newRuntimeValue) {
+        runtimeValue = newRuntimeValue;
+        invalidate();
+      }
 #endif
     }
 
@@ -330,5 +335,6 @@ class ComboChannelBar : public ChannelBar
     uint32_t textColor = COLOR_THEME_SECONDARY1;
 #if defined(OVERRIDE_CHANNEL_FUNCTION)
     int safetyChValue = OVERRIDE_CHANNEL_UNDEFINED;
+    bool runtimeValue = false;
 #endif
 };
@@ -22,6 +22,7 @@
 #include "opentx.h"
 #include "lcd.h"
 #include "theme_manager.h"
+#include "text_cache.h"
 
 coord_t drawStringWithIndex(BitmapBuffer * dc, coord_t x, coord_t y, const char * str, int idx, LcdFlags flags, const char * prefix, const char * suffix)
 {
@@ -442,7 +443,7 @@ void drawTimer(BitmapBuffer * dc, coord_t x, coord_t y, int32_t tme, LcdFlags fl
   TimerOptions timerOptions;
   timerOptions.options = (flags & TIMEHOUR) != 0 ? SHOW_TIME : SHOW_TIMER;
   getTimerString(str, tme, timerOptions);
-  dc->drawText(x, y, str, flags);
+  drawCachedText(dc, x, y, str, flags);
 }
 
 void drawSourceValue(BitmapBuffer * dc, coord_t x, coord_t y, source_t source, LcdFlags flags)
@@ -503,12 +504,14 @@ void drawSourceCustomValue(BitmapBuffer * dc, coord_t x, coord_t y, source_t sou
 
 void drawValueWithUnit(BitmapBuffer * dc, coord_t x, coord_t y, int val, uint8_t unit, LcdFlags flags)
 {
+  char s[32];
   if ((flags & NO_UNIT) || unit == UNIT_RAW) {
-    dc->drawNumber(x, y, val, flags & (~NO_UNIT));
+    BitmapBuffer::formatNumberAsString(s, sizeof(s), val, flags & (~NO_UNIT));
   }
   else {
-    dc->drawNumber(x, y, val, flags & (~NO_UNIT), 0, nullptr, TEXT_AT_INDEX(STR_VTELEMUNIT, unit).c_str());
+    BitmapBuffer::formatNumberAsString(s, sizeof(s), val, flags & (~NO_UNIT), 0, nullptr, TEXT_AT_INDEX(STR_VTELEMUNIT, unit).c_str());
   }
+  drawCachedText(dc, x, y, s, flags & (~NO_UNIT));
 }
 
 void drawHexNumber(BitmapBuffer * dc, coord_t x, coord_t y, uint32_t val, LcdFlags flags)
@@ -49,9 +49,30 @@ uint8_t getFontHeight(LcdFlags flags)
   return fontspecsTable[fontindex][0];
 }
 
+// ASCII glyph widths, one table per font, filled on first use
+static uint8_t asciiWidthsTable[FONTS_COUNT][ASCII_GLYPHS_COUNT];
+static bool asciiWidthsLoaded[FONTS_COUNT];
+
+const uint8_t * getFontAsciiWidths(uint32_t fontindex)
+{
+  uint8_t * widths = asciiWidthsTable[fontindex];
+  if (!asciiWidthsLoaded[fontindex]) {
+    const uint16_t * specs = fontspecsTable[fontindex];
+    unsigned count = min<unsigned>(ASCII_GLYPHS_COUNT, fontCharactersTable[fontindex]);
+    for (unsigned i = 0; i < count; i++) {
+      widths[i] = getFontPatternWidth(specs, i);
+    }
+    asciiWidthsLoaded[fontindex] = true;
+  }
+  return widths;
+}
+
 int getTextWidth(const char * s, int len, LcdFlags flags)
 {
-  const uint16_t * specs = fontspecsTable[FONT_INDEX(flags)];
+  const uint32_t fontindex = FONT_INDEX(flags);
+  const uint16_t * specs = fontspecsTable[fontindex];
+  const uint8_t * asciiWidths = getFontAsciiWidths(fontindex);
+  const unsigned charsCount = fontCharactersTable[fontindex];
 
   int result = 0;
   for (int i = 0; len == 0 || i < len; ++i) {
@@ -59,6 +80,9 @@ int getTextWidth(const char * s, int len, LcdFlags flags)
     if (!c) {
       break;
     }
+    else if (c - 0x20u < ASCII_GLYPHS_COUNT && c - 0x20u < charsCount) {
+      result += asciiWidths[c - 0x20u];
+    }
     else if (c >= 0xFE) { // CJK marker
       s++;
       c = uint8_t(*s) + ((c & 0x01) << 8) - 1;
@@ -67,7 +91,7 @@ int getTextWidth(const char * s, int len, LcdFlags flags)
       c += CJK_FIRST_LETTER_INDEX;
       result += getFontPatternWidth(specs, c) + 1;
     }
-    else if ((c >= 0x20u) && (c < fontCharactersTable[FONT_INDEX(flags)] + 0x20u)) {
+    else if ((c >= 0x20u) && (c < charsCount + 0x20u)) {
       result += getCharWidth(c, specs);
     }
     else {
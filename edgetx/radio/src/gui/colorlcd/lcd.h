@@ -41,6 +41,11 @@
 
 extern coord_t lcdNextPos;
 
+// glyphs 0x20..0x7F, which have a fast path in getTextWidth()
+#define ASCII_GLYPHS_COUNT             (0x80 - 0x20)
+
+const uint8_t * getFontAsciiWidths(uint32_t fontindex);
+
 inline void lcdClear()
 {
   lcd->clear();
@@ -23,6 +23,7 @@
 #include "model_select.h"
 #include "opentx.h"
 #include "storage/modelslist.h"
+#include "bitmap_cache.h"
 #include "libopenui.h"
 
 #if LCD_W > LCD_H
@@ -76,6 +77,14 @@ class ModelButton : public Button
       memcpy(&partialModel.header, &g_model.header, sizeof(partialModel));
 #if defined(SDCARD_RAW)
       version = EEPROM_VER;
+#endif
+    } else if (modelCell->valid_rfData) {
+      // already known from the models index
+      memclear(&partialModel, sizeof(partialModel));
+      strncpy(partialModel.header.bitmap, modelCell->modelBitmap,
+              LEN_BITMAP_NAME);
+#if defined(SDCARD_RAW)
+      version = EEPROM_VER;
 #endif
     } else {
 #if defined(SDCARD_RAW)
@@ -122,10 +131,10 @@ class ModelButton : public Button
                        COLOR_THEME_SECONDARY1 | CENTERED);
     } else {
       GET_FILENAME(filename, BITMAPS_PATH, partialModel.header.bitmap, "");
-      const BitmapBuffer *bitmap = BitmapBuffer::loadBitmap(filename);
+      const BitmapBuffer *bitmap = bitmapCacheLoad(filename);
       if (bitmap) {
         buffer->drawScaledBitmap(bitmap, 0, 0, width(), height());
-        delete bitmap;
+        bitmapCacheRelease(bitmap);
       } else {
         buffer->drawText(width() / 2, 56, "(No Picture)",
                          FONT(XXS) | COLOR_THEME_SECONDARY1 | CENTERED);
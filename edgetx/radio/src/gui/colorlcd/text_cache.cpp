@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "opentx.h"
+#include "text_cache.h"
+
+struct TextCacheEntry
+{
+  uint8_t * run;   // uint16 width, uint16 height, then the 8 bit mask
+  uint32_t lastUsed;
+  uint8_t font;
+  char text[TEXT_CACHE_MAX_LEN + 1];
+};
+
+static TextCacheEntry textCache[TEXT_CACHE_ENTRIES];
+static TextCacheStats textCacheStats;
+static uint32_t textCacheClock;
+
+static void textCacheFree(TextCacheEntry & entry)
+{
+  if (entry.run) {
+    textCacheStats.size -= 4 + ((uint16_t *)entry.run)[0] * ((uint16_t *)entry.run)[1];
+    free(entry.run);
+    entry.run = nullptr;
+  }
+  entry.text[0] = '\0';
+}
+
+void textCacheClear()
+{
+  for (auto & entry: textCache) {
+    textCacheFree(entry);
+  }
+}
+
+const TextCacheStats & textCacheGetStats()
+{
+  return textCacheStats;
+}
+
+void textCacheResetStats()
+{
+  textCacheStats.hits = 0;
+  textCacheStats.misses = 0;
+}
+
+// only plain printable ASCII goes through the cache
+static bool isCacheableText(const char * s, unsigned charsCount)
+{
+  unsigned len = 0;
+  for (; *s; s++) {
+    unsigned c = uint8_t(*s) - 0x20u;
+    if (c >= ASCII_GLYPHS_COUNT || c >= charsCount || ++len > TEXT_CACHE_MAX_LEN)
+      return false;
+  }
+  return len > 0;
+}
+
+// Copy the glyphs side by side, exactly as drawText() would draw them.
+// With LCD_VERTICAL_INVERT the font is stored rotated by 180°, the run
+// is built the same way.
+static uint8_t * rasterizeText(const char * s, uint32_t fontindex)
+{
+  const uint16_t * specs = fontspecsTable[fontindex];
+  const uint8_t * font = fontsTable[fontindex];
+  coord_t fontWidth = ((const uint16_t *)font)[0];
+  coord_t height = ((const uint16_t *)font)[1];
+  const uint8_t * asciiWidths = getFontAsciiWidths(fontindex);
+
+  coord_t width = 0;
+  for (const char * c = s; *c; c++) {
+    width += asciiWidths[uint8_t(*c) - 0x20u];
+  }
+
+  if (width <= 0 || 4 + width * height > TEXT_CACHE_MAX_SIZE)
+    return nullptr;
+
+  uint8_t * run = (uint8_t *)malloc(4 + width * height);
+  if (!run)
+    return nullptr;
+
+  ((uint16_t *)run)[0] = width;
+  ((uint16_t *)run)[1] = height;
+
+  coord_t offset = 0;
+  for (; *s; s++) {
+    unsigned index = uint8_t(*s) - 0x20u;
+    coord_t glyphStart = specs[index + 1];
+    coord_t glyphWidth = asciiWidths[index];
+#if defined(LCD_VERTICAL_INVERT)
+    coord_t dstx = width - offset - glyphWidth;
+    coord_t srcx = fontWidth - glyphStart - glyphWidth;
+#else
+    coord_t dstx = offset;
+    coord_t srcx = glyphStart;
+#endif
+    for (coord_t line = 0; line < height; line++) {
+      memcpy(run + 4 + line * width + dstx, font + 4 + line * fontWidth + srcx, glyphWidth);
+    }
+    offset += glyphWidth;
+  }
+
+  return run;
+}
+
+static const uint8_t * textCacheGet(const char * s, uint32_t fontindex)
+{
+  TextCacheEntry * victim = &textCache[0];
+
+  textCacheClock++;
+
+  for (auto & entry: textCache) {
+    if (entry.run && entry.font == fontindex && !strcmp(entry.text, s)) {
+      entry.lastUsed = textCacheClock;
+      textCacheStats.hits++;
+      return entry.run;
+    }
+    if (!entry.run || (victim->run && entry.lastUsed < victim->lastUsed)) {
+      victim = &entry;
+    }
+  }
+
+  textCacheStats.misses++;
+
+  uint8_t * run = rasterizeText(s, fontindex);
+  if (!run)
+    return nullptr;
+
+  textCacheFree(*victim);
+  victim->run = run;
+  victim->font = fontindex;
+  victim->lastUsed = textCacheClock;
+  strcpy(victim->text, s);
+  textCacheStats.size += 4 + ((uint16_t *)run)[0] * ((uint16_t *)run)[1];
+
+  return run;
+}
+
+coord_t drawCachedText(BitmapBuffer * dc, coord_t x, coord_t y, const char * s, LcdFlags flags)
+{
+  uint32_t fontindex = FONT_INDEX(flags);
+
+  if ((flags & (VCENTERED | SHADOWED)) || !isCacheableText(s, fontCharactersTable[fontindex])) {
+    return dc->drawText(x, y, s, flags);
+  }
+
+  const uint8_t * run = textCacheGet(s, fontindex);
+  if (!run) {
+    return dc->drawText(x, y, s, flags);
+  }
+
+  coord_t width = ((const uint16_t *)run)[0];
+  if (flags & RIGHT)
+    x -= width;
+  else if (flags & CENTERED)
+    x -= width / 2;
+
+  dc->drawBitmapPattern(x, y, run, flags);
+  return x + width;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#pragma once
+
+#include "lcd.h"
+
+// Cache of pre-rasterized ASCII text runs (values, timers, ...)
+//
+// A run is stored as an 8 bit mask in the same format as the fonts, so
+// that it can be drawn with a single drawBitmapPattern() (one DMA2D
+// transfer) instead of one transfer per glyph. The color is applied when
+// drawing, so runs are only keyed by font and text.
+
+#define TEXT_CACHE_ENTRIES             16
+#define TEXT_CACHE_MAX_LEN             23
+#define TEXT_CACHE_MAX_SIZE            (64 * 1024)
+
+struct TextCacheStats
+{
+  uint32_t hits;
+  uint32_t misses;
+  uint32_t size;
+};
+
+// Same as dc->drawText(), but reuses a cached run when possible
+coord_t drawCachedText(BitmapBuffer * dc, coord_t x, coord_t y, const char * s, LcdFlags flags);
+
+// Frees all the runs, the screens drawn after a theme change use other texts
+void textCacheClear();
+
+const TextCacheStats & textCacheGetStats();
+void textCacheResetStats();
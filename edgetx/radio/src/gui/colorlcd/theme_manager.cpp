@@ -19,6 +19,7 @@
  * GNU General Public License for more details.
  */
 #include "theme_manager.h"
+#include "text_cache.h"
 
 #define MAX_FILES 9
 ThemePersistance themePersistance;
@@ -310,6 +311,7 @@ void ThemeFile::applyTheme()
 {
   applyColors();
   applyBackground();
+  textCacheClear();
   OpenTxTheme::instance()->update(false);
 }
 
@@ -23,6 +23,7 @@
 #include "tabsgroup.h"
 #include "480_bitmaps.h"
 #include "theme_manager.h"
+#include "bitmap_cache.h"
 
 const ZoneOption OPTIONS_THEME_DEFAULT[] = {
   { STR_BACKGROUND_COLOR, ZoneOption::Color, OPTION_VALUE_UNSIGNED(COLOR_THEME_PRIMARY2) },
@@ -188,11 +189,10 @@ class Theme480: public OpenTxTheme
 
     void setBackgroundImageFileName(const char *fileName) override
     {
-      // ensure you delete old bitmap
-      if (strcmp(backgroundImageFileName, fileName) != 0 && backgroundBitmap != nullptr)
-        delete backgroundBitmap;
+      // release the old bitmap, it stays in the cache if used again
+      bitmapCacheRelease(backgroundBitmap);
       OpenTxTheme::setBackgroundImageFileName(fileName);  // set the filename
-      backgroundBitmap = BitmapBuffer::loadBitmap(backgroundImageFileName);
+      backgroundBitmap = bitmapCacheLoad(backgroundImageFileName);
     }
 
     void loadThemeBitmaps() const
@@ -238,8 +238,8 @@ class Theme480: public OpenTxTheme
       modelselModelMoveIcon = BitmapBuffer::load8bitMask(mask_moveico);
 
       //TODO: should be loaded from LUA, not here!!!
-      delete modelselWizardBackground;
-      modelselWizardBackground = BitmapBuffer::loadBitmap(getFilePath("wizard/background.png"));
+      bitmapCacheRelease(modelselWizardBackground);
+      modelselWizardBackground = bitmapCacheLoad(getFilePath("wizard/background.png"));
 
       // Channels monitor screen
       delete chanMonLockedBitmap;
@@ -295,7 +295,7 @@ class Theme480: public OpenTxTheme
       ThemePersistance::instance()->loadDefaultTheme();
       OpenTxTheme::load();
       if (!backgroundBitmap) {
-        backgroundBitmap = BitmapBuffer::loadBitmap(getFilePath("background.png"));
+        backgroundBitmap = bitmapCacheLoad(getFilePath("background.png"));
       }
       update();
     }
@@ -21,6 +21,7 @@
 
 #include "opentx.h"
 #include "tabsgroup.h"
+#include "bitmap_cache.h"
 
 const ZoneOption OPTIONS_THEME_DEFAULT[] = {
   { STR_BACKGROUND_COLOR, ZoneOption::Color, OPTION_VALUE_UNSIGNED(COLOR_THEME_PRIMARY2) },
@@ -185,14 +186,14 @@ class FlyskyTheme: public OpenTxTheme
     void loadThemeBitmaps() const
     {
       // Calibration screen
-      delete calibStick;
-      calibStick = BitmapBuffer::loadBitmap(getFilePath("stick_pointer.png"));
+      bitmapCacheRelease(calibStick);
+      calibStick = bitmapCacheLoad(getFilePath("stick_pointer.png"));
 
-      delete calibStickBackground;
-      calibStickBackground = BitmapBuffer::loadBitmap(getFilePath("stick_background.png"));
+      bitmapCacheRelease(calibStickBackground);
+      calibStickBackground = bitmapCacheLoad(getFilePath("stick_background.png"));
 
-      delete calibTrackpBackground;
-      calibTrackpBackground = BitmapBuffer::loadBitmap(getFilePath("trackp_background.png"));
+      bitmapCacheRelease(calibTrackpBackground);
+      calibTrackpBackground = bitmapCacheLoad(getFilePath("trackp_background.png"));
 
       // Model Selection screen
       // delete modelselIconBitmap;
@@ -218,8 +219,8 @@ class FlyskyTheme: public OpenTxTheme
       delete modelselModelMoveIcon;
       modelselModelMoveIcon = BitmapBuffer::loadMask(getFilePath("modelsel/mask_moveico.png"));
 
-      delete modelselWizardBackground;
-      modelselWizardBackground = BitmapBuffer::loadBitmap(getFilePath("wizard/background.png"));
+      bitmapCacheRelease(modelselWizardBackground);
+      modelselWizardBackground = bitmapCacheLoad(getFilePath("wizard/background.png"));
 
       // Channels monitor screen
       delete chanMonLockedBitmap;
@@ -274,7 +275,7 @@ class FlyskyTheme: public OpenTxTheme
       loadColors();
       OpenTxTheme::load();
       if (!backgroundBitmap) {
-        backgroundBitmap = BitmapBuffer::loadBitmap(getFilePath("background.png"));
+        backgroundBitmap = bitmapCacheLoad(getFilePath("background.png"));
       }
       update();
     }
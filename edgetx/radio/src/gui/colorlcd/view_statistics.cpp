@@ -22,6 +22,8 @@
 #include "view_statistics.h"
 #include "opentx.h"
 #include "draw_functions.h"
+#include "bitmap_cache.h"
+#include "text_cache.h"
 
 
 StatisticsViewPageGroup::StatisticsViewPageGroup() : TabsGroup(ICON_STATS)
@@ -228,6 +230,34 @@ void DebugViewPage::build(FormWindow *window)
       COLOR_THEME_PRIMARY1, "[Audio] ", nullptr);
   grid.nextLine();
 
+  // Bitmap cache data
+  new StaticText(window, grid.getLabelSlot(), STR_BITMAP_CACHE_LABEL, 0,
+                 COLOR_THEME_PRIMARY1);
+  new DebugInfoNumber<uint32_t>(
+      window, grid.getFieldSlot(3, 0), [] { return bitmapCacheGetStats().hits; },
+      COLOR_THEME_PRIMARY1, "[Hit] ", nullptr);
+  new DebugInfoNumber<uint32_t>(
+      window, grid.getFieldSlot(3, 1), [] { return bitmapCacheGetStats().misses; },
+      COLOR_THEME_PRIMARY1, "[Miss] ", nullptr);
+  new DebugInfoNumber<uint32_t>(
+      window, grid.getFieldSlot(3, 2), [] { return bitmapCacheGetStats().size; },
+      COLOR_THEME_PRIMARY1, "[Size] ", nullptr);
+  grid.nextLine();
+
+  // Text cache data
+  new StaticText(window, grid.getLabelSlot(), STR_TEXT_CACHE_LABEL, 0,
+                 COLOR_THEME_PRIMARY1);
+  new DebugInfoNumber<uint32_t>(
+      window, grid.getFieldSlot(3, 0), [] { return textCacheGetStats().hits; },
+      COLOR_THEME_PRIMARY1, "[Hit] ", nullptr);
+  new DebugInfoNumber<uint32_t>(
+      window, grid.getFieldSlot(3, 1), [] { return textCacheGetStats().misses; },
+      COLOR_THEME_PRIMARY1, "[Miss] ", nullptr);
+  new DebugInfoNumber<uint32_t>(
+      window, grid.getFieldSlot(3, 2), [] { return textCacheGetStats().size; },
+      COLOR_THEME_PRIMARY1, "[Size] ", nullptr);
+  grid.nextLine();
+
 #if defined(DEBUG_LATENCY)
   new StaticText(window, grid.getLabelSlot(), STR_HEARTBEAT_LABEL, 0,
                  COLOR_THEME_PRIMARY1);
@@ -239,6 +269,27 @@ void DebugViewPage::build(FormWindow *window)
     new StaticText(window, grid.getFieldSlot(), "---", 0, COLOR_THEME_PRIMARY1);
 #endif
 
+#if defined(LATENCY_PROBE)
+  // Inputs to module frames latency, in us
+  for (uint8_t stage = 0; stage < LATENCY_PROBE_STAGES; stage++) {
+    new StaticText(window, grid.getLabelSlot(), latencyProbeStageNames[stage],
+                   0, COLOR_THEME_PRIMARY1);
+    new DebugInfoNumber<uint32_t>(
+        window, grid.getFieldSlot(3, 0),
+        [=] { return latencyProbeGetStage(stage).getPercentile(5000); },
+        COLOR_THEME_PRIMARY1, "[p50] ", nullptr);
+    new DebugInfoNumber<uint32_t>(
+        window, grid.getFieldSlot(3, 1),
+        [=] { return latencyProbeGetStage(stage).getPercentile(9900); },
+        COLOR_THEME_PRIMARY1, "[p99] ", nullptr);
+    new DebugInfoNumber<uint32_t>(
+        window, grid.getFieldSlot(3, 2),
+        [=] { return latencyProbeGetStage(stage).getMax(); },
+        COLOR_THEME_PRIMARY1, "[Max] ", nullptr);
+    grid.nextLine();
+  }
+#endif
+
 #if defined(INTERNAL_GPS)
   new StaticText(window, grid.getLabelSlot(), STR_INT_GPS_LABEL, 0,
                  COLOR_THEME_PRIMARY1);
@@ -264,6 +315,13 @@ void DebugViewPage::build(FormWindow *window)
 #if defined(LUA)
         maxLuaInterval = 0;
         maxLuaDuration = 0;
+#endif
+        bitmapCacheResetStats();
+        textCacheResetStats();
+#if defined(LATENCY_PROBE)
+        for (uint8_t stage = 0; stage < LATENCY_PROBE_STAGES; stage++) {
+          latencyProbeGetStage(stage).reset();
+        }
 #endif
         return 0;
       },
@@ -24,6 +24,36 @@
 uint8_t gvarDisplayTimer = 0;
 uint8_t gvarLastChanged = 0;
 
+static int16_t gvarRuntimeValues[MAX_GVARS];
+static uint16_t gvarRuntimeMask;
+
+static_assert(MAX_GVARS <= 16, "gvarRuntimeMask too small");
+
+void setGVarRuntimeValues(uint8_t first, const int16_t * values, uint8_t count)
+{
+  for (uint8_t i = 0; i < count && first + i < MAX_GVARS; i++) {
+    gvarRuntimeValues[first + i] = limit<int16_t>(-GVAR_MAX, values[i], GVAR_MAX);
+    gvarRuntimeMask |= 1u << (first + i);
+  }
+}
+
+void clearGVarRuntimeValues()
+{
+  gvarRuntimeMask = 0;
+}
+
+bool isGVarRuntimeValue(uint8_t gv)
+{
+  return gvarRuntimeMask & (1u << gv);
+}
+
+static int16_t getGVarCurrentValue(uint8_t gv, int8_t fm)
+{
+  if (isGVarRuntimeValue(gv))
+    return gvarRuntimeValues[gv];
+  return GVAR_VALUE(gv, getGVarFlightMode(fm, gv));
+}
+
 uint8_t getGVarFlightMode(uint8_t fm, uint8_t gv) // TODO change params order to be consistent!
 {
   for (uint8_t i=0; i<MAX_FLIGHT_MODES; i++) {
@@ -44,7 +74,7 @@ int16_t getGVarValue(int8_t gv, int8_t fm)
     gv = -1-gv;
     mul = -1;
   }
-  return GVAR_VALUE(gv, getGVarFlightMode(fm, gv)) * mul;
+  return getGVarCurrentValue(gv, fm) * mul;
 }
 
 int32_t getGVarValuePrec1(int8_t gv, int8_t fm)
@@ -54,7 +84,7 @@ int32_t getGVarValuePrec1(int8_t gv, int8_t fm)
   if (gv < 0) {
     mul = -mul;
   }
-  return GVAR_VALUE(idx, getGVarFlightMode(fm, idx)) * mul;
+  return getGVarCurrentValue(idx, fm) * mul;
 }
 
 void setGVarValue(uint8_t gv, int16_t value, int8_t fm)
@@ -43,6 +43,12 @@
     #define SET_GVAR(idx, val, fm)     setGVarValue(idx, val, fm)
     #define GVAR_DISPLAY_TIME          100 /*1 second*/;
     #define GET_GVAR_PREC1(x, min, max, fm) getGVarFieldValuePrec1(x, min, max, fm)
+
+    // Runtime values replace the stored ones in all flight modes. They live
+    // in RAM only, setting them never triggers a model save
+    void setGVarRuntimeValues(uint8_t first, const int16_t * values, uint8_t count);
+    void clearGVarRuntimeValues();
+    bool isGVarRuntimeValue(uint8_t gv);
     extern uint8_t gvarDisplayTimer;
     extern uint8_t gvarLastChanged;
 #else
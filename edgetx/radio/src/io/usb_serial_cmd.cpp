@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "opentx.h"
+#include "stamp.h"
+#include "usb_serial_cmd.h"
+
+enum UsbCmdState {
+  USB_CMD_STATE_SYNC,
+  USB_CMD_STATE_LEN,
+  USB_CMD_STATE_CMD,
+  USB_CMD_STATE_PAYLOAD,
+  USB_CMD_STATE_CRC,
+};
+
+static uint8_t usbCmdState = USB_CMD_STATE_SYNC;
+static uint8_t usbCmdFrame[2 + USB_CMD_MAX_PAYLOAD];   // LEN, CMD, PAYLOAD
+static uint8_t usbCmdIndex;
+
+static void usbSerialCmdReply(uint8_t cmd, const uint8_t * payload, uint8_t len)
+{
+  uint8_t frame[4 + USB_CMD_MAX_PAYLOAD];
+  frame[0] = USB_CMD_SYNC;
+  frame[1] = len;
+  frame[2] = cmd;
+  if (len > 0) {
+    memcpy(&frame[3], payload, len);
+  }
+  frame[3 + len] = crc8(&frame[1], 2 + len);
+  // the host is expected to retry if the reply doesn't fit in the buffer
+  usbSerialWrite(frame, 4 + len);
+}
+
+static void usbSerialCmdExecute(uint8_t cmd, const uint8_t * payload, uint8_t len)
+{
+  uint8_t reply[USB_CMD_MAX_PAYLOAD];
+
+  switch (cmd) {
+    case USB_CMD_PING:
+      usbSerialCmdReply(cmd | USB_CMD_REPLY, payload, len);
+      break;
+
+    case USB_CMD_GET_VERSION:
+    {
+      static const char version[] = VERSION;
+      usbSerialCmdReply(cmd | USB_CMD_REPLY, (const uint8_t *)version, min<uint8_t>(sizeof(version) - 1, USB_CMD_MAX_PAYLOAD));
+      break;
+    }
+
+    case USB_CMD_GET_CHANNELS:
+    {
+      uint8_t count = min<uint8_t>(MAX_OUTPUT_CHANNELS, USB_CMD_MAX_PAYLOAD / 2);
+      for (uint8_t i = 0; i < count; i++) {
+        int16_t value = channelOutputs[i];
+        reply[2 * i] = value & 0xFF;
+        reply[2 * i + 1] = value >> 8;
+      }
+      usbSerialCmdReply(cmd | USB_CMD_REPLY, reply, 2 * count);
+      break;
+    }
+
+    case USB_CMD_SET_TRAINER:
+    {
+      uint8_t count = min<uint8_t>(len / 2, MAX_TRAINER_CHANNELS);
+      for (uint8_t i = 0; i < count; i++) {
+        int16_t value = payload[2 * i] + (payload[2 * i + 1] << 8);
+        ppmInput[i] = limit<int16_t>(-512, value, 512);
+      }
+      if (count > 0) {
+        ppmInputValidityTimer = PPM_IN_VALID_TIMEOUT;
+        LATENCY_PROBE_INPUT();
+      }
+      usbSerialCmdReply(cmd | USB_CMD_REPLY, nullptr, 0);
+      break;
+    }
+
+#if defined(DEBUG_TIMERS)
+    case USB_CMD_GET_DEBUG_TIMER:
+      if (len >= 1 && payload[0] < DEBUG_TIMERS_COUNT) {
+        DebugTimer & timer = debugTimers[payload[0]];
+        DebugTimerStats stats;
+        timer.getStats(stats);
+        timer.reset();
+        const uint32_t values[] = { stats.count, stats.min, stats.max, stats.avg, stats.p50, stats.p99, stats.p999 };
+        reply[0] = payload[0];
+        uint8_t * p = &reply[1];
+        for (auto value: values) {
+          for (uint8_t i = 0; i < 4; i++) {
+            *p++ = value >> (8 * i);
+          }
+        }
+        usbSerialCmdReply(cmd | USB_CMD_REPLY, reply, p - reply);
+        break;
+      }
+      reply[0] = cmd;
+      usbSerialCmdReply(USB_CMD_ERROR, reply, 1);
+      break;
+
+    case USB_CMD_GET_DEBUG_TIMER_HISTOGRAM:
+      // the histogram must be read before the stats, which reset the timer
+      if (len >= 2 && payload[0] < DEBUG_TIMERS_COUNT && payload[1] < DEBUG_TIMER_BUCKETS) {
+        DebugTimer & timer = debugTimers[payload[0]];
+        uint8_t count = min<uint8_t>(DEBUG_TIMER_BUCKETS - payload[1], (USB_CMD_MAX_PAYLOAD - 2) / 2);
+        reply[0] = payload[0];
+        reply[1] = payload[1];
+        for (uint8_t i = 0; i < count; i++) {
+          uint16_t value = timer.getBucket(payload[1] + i);
+          reply[2 + 2 * i] = value & 0xFF;
+          reply[3 + 2 * i] = value >> 8;
+        }
+        usbSerialCmdReply(cmd | USB_CMD_REPLY, reply, 2 + 2 * count);
+        break;
+      }
+      reply[0] = cmd;
+      usbSerialCmdReply(USB_CMD_ERROR, reply, 1);
+      break;
+#endif
+
+#if defined(EVENT_TRACE)
+    case USB_CMD_EVENT_TRACE:
+      if (len >= 1 && payload[0] <= EVENT_TRACE_OUTPUT_AUX) {
+        // replied first, so that the reply is not mixed with the trace
+        usbSerialCmdReply(cmd | USB_CMD_REPLY, nullptr, 0);
+        eventTraceStart(payload[0]);
+        break;
+      }
+      reply[0] = cmd;
+      usbSerialCmdReply(USB_CMD_ERROR, reply, 1);
+      break;
+#endif
+
+    default:
+      reply[0] = cmd;
+      usbSerialCmdReply(USB_CMD_ERROR, reply, 1);
+      break;
+  }
+}
+
+static void usbSerialCmdParse(uint8_t byte)
+{
+  switch (usbCmdState) {
+    case USB_CMD_STATE_SYNC:
+      // anything else is skipped until the next frame
+      if (byte == USB_CMD_SYNC) {
+        usbCmdState = USB_CMD_STATE_LEN;
+      }
+      break;
+
+    case USB_CMD_STATE_LEN:
+      if (byte > USB_CMD_MAX_PAYLOAD) {
+        usbCmdState = (byte == USB_CMD_SYNC ? USB_CMD_STATE_LEN : USB_CMD_STATE_SYNC);
+      }
+      else {
+        usbCmdFrame[0] = byte;
+        usbCmdState = USB_CMD_STATE_CMD;
+      }
+      break;
+
+    case USB_CMD_STATE_CMD:
+      usbCmdFrame[1] = byte;
+      usbCmdIndex = 0;
+      usbCmdState = (usbCmdFrame[0] > 0 ? USB_CMD_STATE_PAYLOAD : USB_CMD_STATE_CRC);
+      break;
+
+    case USB_CMD_STATE_PAYLOAD:
+      usbCmdFrame[2 + usbCmdIndex++] = byte;
+      if (usbCmdIndex == usbCmdFrame[0]) {
+        usbCmdState = USB_CMD_STATE_CRC;
+      }
+      break;
+
+    case USB_CMD_STATE_CRC:
+      if (byte == crc8(usbCmdFrame, 2 + usbCmdFrame[0])) {
+        usbSerialCmdExecute(usbCmdFrame[1], &usbCmdFrame[2], usbCmdFrame[0]);
+      }
+      else {
+        TRACE("USB command: bad CRC");
+      }
+      usbCmdState = USB_CMD_STATE_SYNC;
+      break;
+  }
+}
+
+bool usbSerialCmdActive()
+{
+  return getSelectedUsbMode() == USB_SERIAL_MODE && usbSerialBaudRate() == USB_CMD_BAUDRATE;
+}
+
+void usbSerialCmdProcess()
+{
+  if (!usbSerialCmdActive()) {
+    // a frame is never continued across two sessions
+    usbCmdState = USB_CMD_STATE_SYNC;
+    return;
+  }
+
+  // at most what the FIFO can hold, so that a flooding host can't stall the caller
+  uint8_t buffer[64];
+  size_t total = 0;
+  while (total < USB_SERIAL_RX_FIFO_SIZE) {
+    size_t count = usbSerialRead(buffer, sizeof(buffer));
+    if (count == 0)
+      break;
+    for (size_t i = 0; i < count; i++) {
+      usbSerialCmdParse(buffer[i]);
+    }
+    total += count;
+  }
+}
+
+size_t usbSerialCmdReadData(uint8_t * buf, size_t len)
+{
+  if (usbSerialCmdActive())
+    return 0;
+  return usbSerialRead(buf, len);
+}
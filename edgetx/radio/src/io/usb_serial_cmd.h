@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Native binary command channel over USB serial (without CLI)
+//
+// The channel is only active while the host has opened the port with the
+// USB_CMD_BAUDRATE line coding: the whole stream is then made of command
+// frames. With any other baudrate the data is left untouched to Lua
+// serialRead().
+//
+// Frame: SYNC, LEN, CMD, PAYLOAD[LEN], CRC8
+// The CRC is computed over LEN, CMD and PAYLOAD. Each command is answered
+// with the same framing and CMD | USB_CMD_REPLY, or USB_CMD_ERROR.
+
+#define USB_CMD_BAUDRATE               1228800
+#define USB_CMD_SYNC                   0x7E
+#define USB_CMD_MAX_PAYLOAD            64
+#define USB_CMD_REPLY                  0x80
+#define USB_CMD_ERROR                  0xFF
+
+enum UsbSerialCommand {
+  USB_CMD_PING = 0x01,          // payload echoed back
+  USB_CMD_GET_VERSION = 0x02,   // reply: version string
+  USB_CMD_GET_CHANNELS = 0x03,  // reply: channel outputs (int16 LE, -1024..1024)
+  USB_CMD_SET_TRAINER = 0x04,   // payload: trainer inputs (int16 LE, -512..512 us from 1500)
+  USB_CMD_GET_DEBUG_TIMER = 0x05,           // payload: index, reply: index, count, min, max, avg, p50, p99, p99.9 (uint32 LE, us), then the timer is reset
+  USB_CMD_GET_DEBUG_TIMER_HISTOGRAM = 0x06, // payload: index, first bucket, reply: index, first bucket, bucket counts (uint16 LE)
+  USB_CMD_EVENT_TRACE = 0x07,               // payload: EventTraceOutput, the packets follow on the chosen output
+};
+
+bool usbSerialCmdActive();
+void usbSerialCmdProcess();
+
+// Reads the USB data, none while the command channel is active
+size_t usbSerialCmdReadData(uint8_t * buf, size_t len);
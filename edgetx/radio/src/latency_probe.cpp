@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#include "opentx.h"
+#include "latency_probe.h"
+
+struct LatencyProbeFrame
+{
+  uint32_t mixerTime;
+  uint32_t adcTime;
+  uint32_t inputTime;
+  bool input;
+  volatile bool pending;   // not sent yet
+};
+
+static uint32_t latencyAdcTime;
+static uint32_t latencyMixerInputTime;
+static bool latencyMixerInput;
+static volatile uint32_t latencyInputTime;
+static volatile bool latencyInputPending;
+static LatencyProbeFrame latencyFrames[NUM_MODULES];
+
+static DebugTimer latencyStages[LATENCY_PROBE_STAGES];
+
+const char * const latencyProbeStageNames[LATENCY_PROBE_STAGES] = {
+   "ADC->mixer "   // LATENCY_ADC_TO_MIXER,
+  ,"Input->mix "   // LATENCY_INPUT_TO_MIXER,
+  ,"Mixer->int "   // LATENCY_MIXER_TO_INTMODULE,
+  ,"Mixer->ext "   // LATENCY_MIXER_TO_EXTMODULE,
+  ,"ADC->int   "   // LATENCY_ADC_TO_INTMODULE,
+  ,"ADC->ext   "   // LATENCY_ADC_TO_EXTMODULE,
+  ,"Input->int "   // LATENCY_INPUT_TO_INTMODULE,
+  ,"Input->ext "   // LATENCY_INPUT_TO_EXTMODULE,
+};
+
+static void latencyProbeSample(uint8_t stage, uint32_t now, uint32_t time)
+{
+  latencyStages[stage].addSample((now - time) / SYSTEM_TICKS_1US);
+}
+
+DebugTimer & latencyProbeGetStage(uint8_t stage)
+{
+  return latencyStages[stage];
+}
+
+// end of the stick / pots conversion, mixer task
+void latencyProbeAdc()
+{
+  latencyAdcTime = ticksNow();
+}
+
+// trainer / serial channels received, any context. Only the oldest
+// input not seen by the mixer yet is kept.
+void latencyProbeInput()
+{
+  if (!latencyInputPending) {
+    latencyInputTime = ticksNow();
+    latencyInputPending = true;
+  }
+}
+
+void latencyProbeMixerStart()
+{
+  latencyMixerInput = latencyInputPending;
+  if (latencyMixerInput) {
+    uint32_t now = ticksNow();
+    latencyMixerInputTime = latencyInputTime;
+    latencyInputPending = false;
+    latencyProbeSample(LATENCY_INPUT_TO_MIXER, now, latencyMixerInputTime);
+  }
+}
+
+void latencyProbeMixerEnd()
+{
+  uint32_t now = ticksNow();
+  latencyProbeSample(LATENCY_ADC_TO_MIXER, now, latencyAdcTime);
+
+  for (auto & frame: latencyFrames) {
+    // the frame may be sent from an interrupt
+    frame.pending = false;
+    frame.mixerTime = now;
+    frame.adcTime = latencyAdcTime;
+    frame.inputTime = latencyMixerInputTime;
+    frame.input = latencyMixerInput;
+    __DMB();
+    frame.pending = true;
+  }
+}
+
+// frame handed to the module hardware (UART DMA, PPM / PXX timer)
+void latencyProbeFrame(uint8_t module)
+{
+  LatencyProbeFrame & frame = latencyFrames[module];
+  if (!frame.pending)
+    return;
+  frame.pending = false;
+
+  uint32_t now = ticksNow();
+  uint8_t offset = (module == INTERNAL_MODULE ? 0 : 1);
+  latencyProbeSample(LATENCY_MIXER_TO_INTMODULE + offset, now, frame.mixerTime);
+  latencyProbeSample(LATENCY_ADC_TO_INTMODULE + offset, now, frame.adcTime);
+  if (frame.input) {
+    latencyProbeSample(LATENCY_INPUT_TO_INTMODULE + offset, now, frame.inputTime);
+  }
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+
+#pragma once
+
+#include <stdint.h>
+
+// End-to-end latency measurement, from the inputs to the RF module frames
+//
+// Samples are timestamped with the CPU cycle counter when they are taken
+// (stick ADC conversion, trainer / serial channels arrival), followed
+// through the mixer, and the latency of each stage is recorded when the
+// first frame computed from them is handed to the module UART / timer.
+// Frames which only repeat older mixer outputs are not counted. The
+// distributions are kept in DebugTimer histograms (1us unit).
+
+enum LatencyProbeStage {
+  LATENCY_ADC_TO_MIXER,                // stick sample -> mixer outputs ready
+  LATENCY_INPUT_TO_MIXER,              // trainer / serial input -> mixer start
+  LATENCY_MIXER_TO_INTMODULE,          // mixer outputs -> internal module frame
+  LATENCY_MIXER_TO_EXTMODULE,          // mixer outputs -> external module frame
+  LATENCY_ADC_TO_INTMODULE,            // total, from the stick sample
+  LATENCY_ADC_TO_EXTMODULE,
+  LATENCY_INPUT_TO_INTMODULE,          // total, from the trainer / serial input
+  LATENCY_INPUT_TO_EXTMODULE,
+  LATENCY_PROBE_STAGES
+};
+
+void latencyProbeAdc();
+void latencyProbeInput();
+void latencyProbeMixerStart();
+void latencyProbeMixerEnd();
+void latencyProbeFrame(uint8_t module);
+
+// LATENCY_PROBE builds have DEBUG_TIMERS
+class DebugTimer;
+DebugTimer & latencyProbeGetStage(uint8_t stage);
+extern const char * const latencyProbeStageNames[LATENCY_PROBE_STAGES];
+
+#if defined(LATENCY_PROBE)
+  #define LATENCY_PROBE_ADC()              latencyProbeAdc()
+  #define LATENCY_PROBE_INPUT()            latencyProbeInput()
+  #define LATENCY_PROBE_MIXER_START()      latencyProbeMixerStart()
+  #define LATENCY_PROBE_MIXER_END()        latencyProbeMixerEnd()
+  #define LATENCY_PROBE_FRAME(module)      latencyProbeFrame(module)
+#else
+  #define LATENCY_PROBE_ADC()
+  #define LATENCY_PROBE_INPUT()
+  #define LATENCY_PROBE_MIXER_START()
+  #define LATENCY_PROBE_MIXER_END()
+  #define LATENCY_PROBE_FRAME(module)
+#endif
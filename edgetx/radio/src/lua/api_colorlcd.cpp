@@ -25,6 +25,7 @@
 #include "libopenui.h"
 #include "widget.h"
 #include "api_colorlcd.h"
+#include "bitmap_cache.h"
 
 BitmapBuffer* luaLcdBuffer  = nullptr;
 Widget* runningFS = nullptr;
@@ -534,10 +535,11 @@ static int luaOpenBitmap(lua_State *L)
           luaExtraMemoryUsage, LUA_MEM_EXTRA_MAX);
     *b = 0;
   } else {
-    *b = BitmapBuffer::loadBitmap(filename);
+    // bitmaps are shared with the UI and never drawn into by Lua
+    *b = const_cast<BitmapBuffer *>(bitmapCacheLoad(filename));
     if (*b == NULL && G(L)->gcrunning) {
-      luaC_fullgc(L, 1);                       /* try to free some memory... */
-      *b = BitmapBuffer::loadBitmap(filename); /* try again */
+      luaC_fullgc(L, 1);                                          /* try to free some memory... */
+      *b = const_cast<BitmapBuffer *>(bitmapCacheLoad(filename)); /* try again */
     }
   }
 
@@ -600,7 +602,7 @@ static int luaDestroyBitmap(lua_State * L)
     else {
       luaExtraMemoryUsage = 0;
     }
-    delete b;
+    bitmapCacheRelease(b);
   }
   return 0;
 }
@@ -27,6 +27,9 @@
 #include "api_filesystem.h"
 #include "telemetry/frsky.h"
 #include "telemetry/multi.h"
+#if defined(USB_SERIAL)
+  #include "io/usb_serial_cmd.h"
+#endif
 
 #if defined(LIBOPENUI)
   #include "libopenui.h"
@@ -1785,6 +1788,55 @@ static int luaGetAvailableMemory(lua_State * L)
   return 1;
 }
 
+#if defined(DEBUG_TIMERS)
+/*luadoc
+@function getDebugTimer(index)
+
+Get the statistics of a debug timer, and reset it (debug builds only)
+
+@param index (number) timer index, starting at 0
+
+@retval nil if the index is out of range, otherwise a table:
+ * `name` (string) timer name
+ * `count` (number) number of samples since the last read
+ * `min`, `max`, `avg` (number) times in us
+ * `p50`, `p99`, `p999` (number) percentiles in us, from a log-scale histogram (25% max error)
+
+@status current Introduced in 2.7.0
+*/
+static int luaGetDebugTimer(lua_State * L)
+{
+  int index = luaL_checkinteger(L, 1);
+  if (index < 0 || index >= DEBUG_TIMERS_COUNT) {
+    lua_pushnil(L);
+    return 1;
+  }
+
+  DebugTimerStats stats;
+  debugTimers[index].getStats(stats);
+  debugTimers[index].reset();
+
+  // the names are padded for the CLI
+  const char * name = debugTimerNames[index];
+  while (*name == ' ') name++;
+  size_t len = strlen(name);
+  while (len > 0 && name[len - 1] == ' ') len--;
+
+  lua_newtable(L);
+  lua_pushstring(L, "name");
+  lua_pushlstring(L, name, len);
+  lua_settable(L, -3);
+  lua_pushtableinteger(L, "count", stats.count);
+  lua_pushtableinteger(L, "min", stats.min);
+  lua_pushtableinteger(L, "max", stats.max);
+  lua_pushtableinteger(L, "avg", stats.avg);
+  lua_pushtableinteger(L, "p50", stats.p50);
+  lua_pushtableinteger(L, "p99", stats.p99);
+  lua_pushtableinteger(L, "p999", stats.p999);
+  return 1;
+}
+#endif
+
 /*luadoc
 @function resetGlobalTimer([type])
 
@@ -1891,23 +1943,28 @@ static int luaSetSerialBaudrate(lua_State * L)
 @function serialWrite(str)
 @param str (string) String to be written to the serial port.
 
+@retval number number of bytes written. When the USB port is in serial mode, it is less than
+the string length if the USB buffer is full: the script may write the remaining bytes later.
+
 Writes a string to the serial port. The string is allowed to contain any character, including 0.
 
-@status current Introduced in 2.3.10
+@status current Introduced in 2.3.10, returns the number of bytes written since 2.7.0
 */
 static int luaSerialWrite(lua_State * L)
 {
   const char * str = luaL_checkstring(L, 1);
   size_t len = lua_rawlen(L, 1);
 
-  if (!str || len < 1)
-    return 0;
+  if (!str || len < 1) {
+    lua_pushunsigned(L, 0);
+    return 1;
+  }
+
+  size_t written = len;
 
 #if defined(USB_SERIAL)
-  if (getSelectedUsbMode() == USB_SERIAL_MODE) {
-    size_t wr_len = len;
-    const char* p = str;
-    while(wr_len--) usbSerialPutc(*p++);
+  if (getSelectedUsbMode() == USB_SERIAL_MODE && !usbSerialCmdActive()) {
+    written = usbSerialWrite((const uint8_t *)str, len);
   }
 #endif
 
@@ -1927,7 +1984,8 @@ static int luaSerialWrite(lua_State * L)
   }
 #endif
 
-  return 0;
+  lua_pushunsigned(L, written);
+  return 1;
 }
 
 /*luadoc
@@ -1941,8 +1999,23 @@ static int luaSerialWrite(lua_State * L)
 
 Reads characters from the serial port. The string is allowed to contain any character, including 0.
 
+When the USB port is in serial mode, characters received from USB are read as well, once those
+of the serial port have been read: a single port is read per call. Nothing is read from USB while
+the host uses the native command channel (port opened at 1228800 bauds).
+
 @status current Introduced in 2.3.8
 */
+#if defined(LUA) && !defined(CLI)
+static bool luaSerialPop(uint8_t & c, bool usb)
+{
+#if defined(USB_SERIAL)
+  if (usb)
+    return usbSerialCmdReadData(&c, 1) == 1;
+#endif
+  return luaRxFifo->pop(c);
+}
+#endif
+
 static int luaSerialRead(lua_State * L)
 {
 #if defined(LUA) && !defined(CLI)
@@ -1955,9 +2028,15 @@ static int luaSerialRead(lua_State * L)
       return 1;
     }
   }
+  // the string never mixes the bytes of two ports
+  bool usb = false;
+#if defined(USB_SERIAL)
+  usb = luaRxFifo->isEmpty() && getSelectedUsbMode() == USB_SERIAL_MODE;
+#endif
+
   uint8_t str[LUA_FIFO_SIZE];
   uint8_t *p = str;
-  while (luaRxFifo->pop(*p)) {
+  while (luaSerialPop(*p, usb)) {
     p++;  // increment only when pop was successful
     if (p - str >= LUA_FIFO_SIZE) {
       // buffer full
@@ -2385,6 +2464,9 @@ const luaL_Reg opentxLib[] = {
   { "loadScript", luaLoadScript },
   { "getUsage", luaGetUsage },
   { "getAvailableMemory", luaGetAvailableMemory },
+#if defined(DEBUG_TIMERS)
+  { "getDebugTimer", luaGetDebugTimer },
+#endif
   { "resetGlobalTimer", luaResetGlobalTimer },
 #if LCD_DEPTH > 1 && !defined(COLORLCD)
   { "GREY", luaGrey },
@@ -1544,12 +1544,108 @@ static int luaModelSetGlobalVariable(lua_State *L)
   int value = luaL_checkinteger(L, 3);
   if (phase < MAX_FLIGHT_MODES && idx < MAX_GVARS && value >= -GVAR_MAX && value <= GVAR_MAX) {
     SET_GVAR(idx, value, phase);
-    storageDirty(EE_MODEL);
+  }
+  return 0;
+}
+
+// Reads up to count integers from the array given as first argument
+static uint8_t luaGetRuntimeValues(lua_State * L, int16_t * values, uint8_t count)
+{
+  luaL_checktype(L, 1, LUA_TTABLE);
+  uint8_t len = min<size_t>(count, lua_rawlen(L, 1));
+  for (uint8_t i = 0; i < len; i++) {
+    lua_rawgeti(L, 1, i + 1);
+    values[i] = luaL_checkinteger(L, -1);
+    lua_pop(L, 1);
+  }
+  return len;
+}
+
+/*luadoc
+@function model.setRuntimeGlobalVariables(values [, first])
+
+Sets runtime values of global variables. They replace the values of all
+flight modes until the model is changed or model.clearRuntimeValues() is
+called, and they are never saved, so they can be updated at a high rate
+(i.e. values received on a serial port). They are also cleared when a
+script fails or the scripts are unloaded.
+
+@param values  table (array) of values, from -1024 to 1024
+
+@param first  (optional) zero based index of the global variable set with
+the first value, default 0
+
+Example:
+
+```lua
+  -- set GV3 and GV4
+  model.setRuntimeGlobalVariables({ 100, -200 }, 2)
+```
+
+@status current Introduced in 2.7.0
+*/
+static int luaModelSetRuntimeGlobalVariables(lua_State *L)
+{
+  unsigned int first = luaL_optunsigned(L, 2, 0);
+  int16_t values[MAX_GVARS];
+  if (first < MAX_GVARS) {
+    uint8_t count = luaGetRuntimeValues(L, values, MAX_GVARS - first);
+    setGVarRuntimeValues(first, values, count);
   }
   return 0;
 }
 #endif
 
+#if defined(OVERRIDE_CHANNEL_FUNCTION)
+/*luadoc
+@function model.setRuntimeChannels(values [, first])
+
+Overrides channels outputs at runtime, like the Override special function
+does. The values are kept until the model is changed or
+model.clearRuntimeValues() is called, and they are never saved. They are
+also cleared when a script fails or the scripts are unloaded, so that the
+channels don't stay at the last value sent.
+
+@param values  table (array) of values, from -1024 to 1024
+
+@param first  (optional) zero based index of the channel set with the
+first value, default 0
+
+@status current Introduced in 2.7.0
+*/
+static int luaModelSetRuntimeChannels(lua_State *L)
+{
+  unsigned int first = luaL_optunsigned(L, 2, 0);
+  int16_t values[MAX_OUTPUT_CHANNELS];
+  if (first < MAX_OUTPUT_CHANNELS) {
+    uint8_t count = luaGetRuntimeValues(L, values, MAX_OUTPUT_CHANNELS - first);
+    setChannelRuntimeValues(first, values, count);
+  }
+  return 0;
+}
+#endif
+
+#if defined(GVARS) || defined(OVERRIDE_CHANNEL_FUNCTION)
+/*luadoc
+@function model.clearRuntimeValues()
+
+Clears the global variables and channels runtime values, the stored values
+are used again
+
+@status current Introduced in 2.7.0
+*/
+static int luaModelClearRuntimeValues(lua_State *L)
+{
+#if defined(GVARS)
+  clearGVarRuntimeValues();
+#endif
+#if defined(OVERRIDE_CHANNEL_FUNCTION)
+  clearChannelRuntimeValues();
+#endif
+  return 0;
+}
+#endif
+
 /*luadoc
 @function model.getSensor(sensor)
 
@@ -1649,6 +1745,13 @@ const luaL_Reg modelLib[] = {
 #if defined (GVARS)
   { "getGlobalVariable", luaModelGetGlobalVariable },
   { "setGlobalVariable", luaModelSetGlobalVariable },
+  { "setRuntimeGlobalVariables", luaModelSetRuntimeGlobalVariables },
+#endif
+#if defined(OVERRIDE_CHANNEL_FUNCTION)
+  { "setRuntimeChannels", luaModelSetRuntimeChannels },
+#endif
+#if defined(GVARS) || defined(OVERRIDE_CHANNEL_FUNCTION)
+  { "clearRuntimeValues", luaModelClearRuntimeValues },
 #endif
   { "getSensor", luaModelGetSensor },
   { "resetSensor", luaModelResetSensor },
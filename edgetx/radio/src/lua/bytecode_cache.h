@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+  #include <lundump.h>
+#if defined(__cplusplus)
+}
+#endif
+
+// The compiled scripts are cached as SCRIPTS/CACHE/<hash>.luac, <hash>
+// being the 64 bits FNV-1a hash of the bytecode header (Lua version, int,
+// size_t and number sizes), of the strip flag and of the script source.
+// A modified script gets a new entry whatever its timestamps, and the
+// entries built by the host precompiler are found the same way.
+// The date of an entry is refreshed (once a day) when it is loaded, and the
+// least recently used entries are removed when a new one takes the cache
+// over LUA_CACHE_MAX_SIZE.
+
+#define LUA_CACHE_HASH_LEN        16  // hexadecimal digits
+#define LUA_CACHE_FILENAME_LEN    (LUA_CACHE_HASH_LEN + 5)  // + ".luac"
+#define LUA_CACHE_MAX_SIZE        (512 * 1024)  // bytes
+
+static inline uint64_t luaCacheHash(uint64_t hash, const void * data, size_t size)
+{
+  const uint8_t * p = (const uint8_t *)data;
+  while (size--) {
+    hash ^= *p++;
+    hash *= 0x100000001B3ULL;
+  }
+  return hash;
+}
+
+static inline uint64_t luaCacheHashInit(int stripDebug)
+{
+  lu_byte header[LUAC_HEADERSIZE + 1];
+  luaU_header(header);
+  header[LUAC_HEADERSIZE] = stripDebug ? 1 : 0;
+  return luaCacheHash(0xCBF29CE484222325ULL, header, sizeof(header));
+}
+
+// filename must hold LUA_CACHE_FILENAME_LEN + 1 chars
+static inline char * luaCacheFilename(char * filename, uint64_t hash)
+{
+  static const char digits[] = "0123456789abcdef";
+  for (int i = LUA_CACHE_HASH_LEN - 1; i >= 0; i--) {
+    filename[i] = digits[hash & 0x0F];
+    hash >>= 4;
+  }
+  memcpy(filename + LUA_CACHE_HASH_LEN, ".luac", 6);
+  return filename + LUA_CACHE_FILENAME_LEN;
+}
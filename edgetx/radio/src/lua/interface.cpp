@@ -29,6 +29,7 @@
 #include "lua_api.h"
 #include "sdcard.h"
 #include "api_filesystem.h"
+#include "bytecode_cache.h"
 
 #if defined(LIBOPENUI)
   #include "api_colorlcd.h"
@@ -268,15 +269,29 @@ void luaGetOutputs(ScriptInputsOutputs & sid)
 }
 #endif
 
+// The runtime values set by the scripts would otherwise stay frozen at their
+// last value once the script setting them is stopped or fails
+static void luaClearRuntimeValues()
+{
+#if defined(GVARS)
+  clearGVarRuntimeValues();
+#endif
+#if defined(OVERRIDE_CHANNEL_FUNCTION)
+  clearChannelRuntimeValues();
+#endif
+}
+
 void luaDisable()
 {
   POPUP_WARNING("Lua disabled!");
   luaState = INTERPRETER_PANIC;
+  luaClearRuntimeValues();
 }
 
 void luaClose(lua_State ** L)
 {
   if (*L) {
+    luaClearRuntimeValues();
     PROTECT_LUA() {
       TRACE("luaClose %p", *L);
       lua_close(*L);  // this should not panic, but we make sure anyway
@@ -407,6 +422,86 @@ static void luaDumpState(lua_State * L, const char * filename, const FILINFO * f
   } else
     TRACE_ERROR("luaDumpState(%s): Error: Could not open output file\n", filename);
 }
+
+/*
+  @fn luaGetCachePath(const char * filename, int stripDebug, char * path)
+  Hash a script source into the name of its bytecode cache entry (see bytecode_cache.h).
+  @param path Receives the cache file path, must hold sizeof(SCRIPTS_CACHE_PATH) + LUA_CACHE_FILENAME_LEN + 1 chars.
+  @retval false if the source could not be read
+*/
+static bool luaGetCachePath(const char * filename, int stripDebug, char * path)
+{
+  FIL file;
+  if (f_open(&file, filename, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+    return false;
+
+  uint64_t hash = luaCacheHashInit(stripDebug);
+  uint8_t buffer[256];
+  UINT read;
+  FRESULT result;
+  while ((result = f_read(&file, buffer, sizeof(buffer), &read)) == FR_OK && read > 0) {
+    hash = luaCacheHash(hash, buffer, read);
+  }
+  f_close(&file);
+
+  if (result != FR_OK)
+    return false;
+
+  luaCacheFilename(strAppend(path, SCRIPTS_CACHE_PATH PATH_SEPARATOR), hash);
+  return true;
+}
+
+// Mark a cache entry as used, at most once a day to spare the SD card
+static void luaTouchCacheEntry(const char * path)
+{
+  FILINFO info;
+  if (f_stat(path, &info) != FR_OK)
+    return;
+
+  DWORD now = get_fattime();
+  if (info.fdate != (WORD)(now >> 16)) {
+    info.fdate = (WORD)(now >> 16);
+    info.ftime = (WORD)now;
+    f_utime(path, &info);
+  }
+}
+
+// Remove the least recently used cache entries, but the one just written (keep),
+// until the cache fits in LUA_CACHE_MAX_SIZE
+static void luaPruneCache(const char * keep)
+{
+  keep += sizeof(SCRIPTS_CACHE_PATH);  // skip the directory
+  while (true) {
+    DIR dir;
+    if (f_opendir(&dir, SCRIPTS_CACHE_PATH) != FR_OK)
+      return;
+
+    FILINFO info;
+    FSIZE_t total = 0;
+    DWORD oldestDate = 0xFFFFFFFF;
+    char oldest[LUA_CACHE_FILENAME_LEN + 1] = "";
+    while (f_readdir(&dir, &info) == FR_OK && info.fname[0] != 0) {
+      if (info.fattrib & AM_DIR)
+        continue;
+      total += info.fsize;
+      DWORD date = ((DWORD)info.fdate << 16) | info.ftime;
+      if (date <= oldestDate && strlen(info.fname) <= LUA_CACHE_FILENAME_LEN && strcmp(info.fname, keep)) {
+        oldestDate = date;
+        strcpy(oldest, info.fname);
+      }
+    }
+    f_closedir(&dir);
+
+    if (total <= LUA_CACHE_MAX_SIZE || !oldest[0])
+      return;
+
+    char path[sizeof(SCRIPTS_CACHE_PATH) + LUA_CACHE_FILENAME_LEN + 1];
+    strcpy(strAppend(path, SCRIPTS_CACHE_PATH PATH_SEPARATOR), oldest);
+    TRACE("luaPruneCache: removing %s", path);
+    if (f_unlink(path) != FR_OK)
+      return;
+  }
+}
 #endif  // LUA_COMPILER
 
 /**
@@ -421,6 +516,8 @@ static void luaDumpState(lua_State * L, const char * filename, const FILINFO * f
     "t" only text.
     "T" (default on simulator) prefer text but load binary if that is the only version available.
     "bt" (default on radio) either binary or text, whichever is newer (binary preferred when timestamps are equal).
+      When the text version exists, its compiled version is taken from (or saved to) the bytecode cache
+      in SCRIPTS/CACHE, which is keyed by the hash of the source instead of the timestamps.
     Add "x" to avoid automatic compilation of source file to .luac version.
       Eg: "tx", "bx", or "btx".
     Add "c" to force compilation of source file to .luac version (even if existing version is newer than source file).
@@ -459,6 +556,9 @@ int luaLoadScriptFileToState(lua_State * L, const char * filename, const char *
 
   bool scriptNeedsCompile = false;
   uint8_t loadFileType = 0;  // 1=text, 2=binary
+  int stripDebug = (strchr(lmode, 'd') ? 0 : 1);
+  char cachePath[sizeof(SCRIPTS_CACHE_PATH) + LUA_CACHE_FILENAME_LEN + 1];
+  bool useCache = false;
 
   memclear(&fnoLuaS, sizeof(FILINFO));
   memclear(&fnoLuaC, sizeof(FILINFO));
@@ -530,6 +630,31 @@ int luaLoadScriptFileToState(lua_State * L, const char * filename, const char *
     return SCRIPT_NOFILE;
   }
 
+  // the bytecode cache replaces the .luac next to the source
+  if (frLuaS == FR_OK && strchr(lmode, 'b') && strchr(lmode, 't') && !strchr(lmode, 'c')) {
+    strcpy(filenameFull + fnamelen, SCRIPT_EXT);
+    useCache = luaGetCachePath(filenameFull, stripDebug, cachePath);
+    if (!useCache && loadFileType == 2)
+      strcpy(filenameFull + fnamelen, SCRIPT_BIN_EXT);
+  }
+
+  if (useCache) {
+    lstatus = luaL_loadfilex(L, cachePath, "b");
+    if (lstatus == LUA_OK) {
+      TRACE("luaLoadScriptFileToState(%s, %s): loaded %s", filename, lmode, cachePath);
+      luaTouchCacheEntry(cachePath);
+      return SCRIPT_OK;
+    }
+    if (lstatus == LUA_ERRSYNTAX) {
+      // corrupted, or compiled for another target
+      TRACE_ERROR("luaLoadScriptFileToState(%s, %s): Invalid cache entry %s: %s\n", filename, lmode, cachePath, lua_tostring(L, -1));
+      f_unlink(cachePath);
+    }
+    lua_pop(L, 1);
+    loadFileType = 1;
+    scriptNeedsCompile = !strchr(lmode, 'x');
+  }
+
 #else  // !defined(LUA_COMPILER)
 
   // use passed file name as-is
@@ -552,8 +677,15 @@ int luaLoadScriptFileToState(lua_State * L, const char * filename, const char *
   }
   if (lstatus == LUA_OK) {
     if (scriptNeedsCompile && loadFileType == 1) {
-      strcpy(filenameFull + fnamelen, SCRIPT_BIN_EXT);
-      luaDumpState(L, filenameFull, &fnoLuaS, (strchr(lmode, 'd') ? 0 : 1));
+      if (useCache) {
+        f_mkdir(SCRIPTS_CACHE_PATH);
+        luaDumpState(L, cachePath, nullptr, stripDebug);
+        luaPruneCache(cachePath);
+      }
+      else {
+        strcpy(filenameFull + fnamelen, SCRIPT_BIN_EXT);
+        luaDumpState(L, filenameFull, &fnoLuaS, stripDebug);
+      }
     }
     ret = SCRIPT_OK;
   }
@@ -791,6 +923,7 @@ void displayLuaError(bool firstCall = false)
 void luaError(lua_State * L, uint8_t error)
 {
   errorState = error;
+  luaClearRuntimeValues();
   const char* msg = lua_tostring(L, -1);
   
   if (msg) {
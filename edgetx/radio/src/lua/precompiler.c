@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+// Host precompiler of Lua scripts into the bytecode cache of the radio.
+//
+//   lua-precompiler [-d] <output directory> <script.lua>...
+//
+// Each script is compiled with the Lua of the radio into
+// <output directory>/<hash>.luac (see bytecode_cache.h), to be copied into
+// SCRIPTS/CACHE on the SD card. The chunks are built with the size_t of the
+// radio (LUAC_SIZE_T), and without debug info unless -d is given.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LUA_CORE
+
+#include "lua.h"
+#include "lobject.h"
+#include "lstate.h"
+#include "lrotable.h"
+#include "bytecode_cache.h"
+
+// the scripts are only compiled, no library is needed
+const luaR_table lua_rotable[] = {
+  {NULL, NULL, NULL, NULL}
+};
+
+struct Source {
+  const char * data;
+  size_t size;
+};
+
+static void * allocator(void * ud, void * ptr, size_t osize, size_t nsize)
+{
+  (void)ud;
+  (void)osize;
+  if (nsize == 0) {
+    free(ptr);
+    return NULL;
+  }
+  return realloc(ptr, nsize);
+}
+
+static const char * reader(lua_State * L, void * ud, size_t * size)
+{
+  struct Source * source = (struct Source *)ud;
+  (void)L;
+  *size = source->size;
+  source->size = 0;
+  return *size ? source->data : NULL;
+}
+
+static int writer(lua_State * L, const void * p, size_t size, void * ud)
+{
+  (void)L;
+  return fwrite(p, 1, size, (FILE *)ud) != size;
+}
+
+static char * readFile(const char * filename, size_t * size)
+{
+  FILE * file = fopen(filename, "rb");
+  if (!file)
+    return NULL;
+
+  char * data = NULL;
+  if (fseek(file, 0, SEEK_END) == 0) {
+    long length = ftell(file);
+    if (length >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+      data = (char *)malloc(length + 1);
+      if (data && fread(data, 1, length, file) != (size_t)length) {
+        free(data);
+        data = NULL;
+      }
+      *size = length;
+    }
+  }
+
+  fclose(file);
+  return data;
+}
+
+static int compile(lua_State * L, const char * filename, const char * directory, int stripDebug)
+{
+  size_t size = 0;
+  char * data = readFile(filename, &size);
+  if (!data) {
+    fprintf(stderr, "%s: cannot read file\n", filename);
+    return 0;
+  }
+
+  uint64_t hash = luaCacheHash(luaCacheHashInit(stripDebug), data, size);
+  char * output = (char *)malloc(strlen(directory) + LUA_CACHE_FILENAME_LEN + 2);
+  sprintf(output, "%s/", directory);
+  luaCacheFilename(output + strlen(output), hash);
+
+  // same chunk name as luaL_loadfilex() on the radio
+  char * chunkname = (char *)malloc(strlen(filename) + 2);
+  sprintf(chunkname, "@%s", filename);
+
+  struct Source source = { data, size };
+  int result = 0;
+  if (lua_load(L, reader, &source, chunkname, "t") != LUA_OK) {
+    fprintf(stderr, "%s\n", lua_tostring(L, -1));
+  }
+  else {
+    FILE * file = fopen(output, "wb");
+    if (!file) {
+      fprintf(stderr, "%s: cannot create file\n", output);
+    }
+    else {
+      result = (luaU_dump(L, getproto(L->top - 1), writer, file, stripDebug) == 0);
+      result = (fclose(file) == 0) && result;
+      if (result)
+        printf("%s -> %s\n", filename, output);
+      else
+        fprintf(stderr, "%s: write error\n", output);
+    }
+  }
+  lua_settop(L, 0);
+
+  free(chunkname);
+  free(output);
+  free(data);
+  return result;
+}
+
+int main(int argc, char ** argv)
+{
+  int stripDebug = 1;
+  int first = 1;
+
+  if (argc > 1 && !strcmp(argv[1], "-d")) {
+    stripDebug = 0;
+    first++;
+  }
+
+  if (argc < first + 2) {
+    fprintf(stderr, "usage: %s [-d] <output directory> <script.lua>...\n", argv[0]);
+    return 1;
+  }
+
+  lua_State * L = lua_newstate(allocator, NULL);
+  if (!L) {
+    fprintf(stderr, "cannot create Lua state\n");
+    return 1;
+  }
+
+  int errors = 0;
+  for (int i = first + 1; i < argc; i++) {
+    if (!compile(L, argv[i], argv[first], stripDebug))
+      errors++;
+  }
+
+  lua_close(L);
+  return errors ? 1 : 0;
+}
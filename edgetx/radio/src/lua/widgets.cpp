@@ -21,6 +21,7 @@
 
 #include <ctype.h>
 #include <stdio.h>
+#include <string>
 #include "opentx.h"
 #include "bin_allocator.h"
 #include "lua_api.h"
@@ -305,24 +306,38 @@ static void l_pushtablebool(const char * key, bool value)
   lua_settable(lsWidgets, -3);
 }
 
+// Stamps of a widget directory and of its main.lua, a cached widget
+// description is valid as long as they are unchanged
+struct LuaWidgetStamp
+{
+  uint16_t dirDate;
+  uint16_t dirTime;
+  uint16_t fileDate;
+  uint16_t fileTime;
+  uint32_t fileSize;
+};
+
+// Registered with the name and options read from the widgets cache (or
+// from a first run of the script), the script itself is only loaded when
+// the first instance of the widget is created
 class LuaWidgetFactory: public WidgetFactory
 {
-  friend void luaLoadWidgetCallback();
+  friend void luaWriteWidgetsCache(const std::string & failed, uint8_t failedCount);
   friend class LuaWidget;
 
   public:
-    LuaWidgetFactory(const char * name, ZoneOption * widgetOptions, int createFunction):
+    LuaWidgetFactory(const char * name, ZoneOption * widgetOptions, const char * directory, const LuaWidgetStamp & stamp):
       WidgetFactory(name, widgetOptions),
-      createFunction(createFunction),
-      updateFunction(0),
-      refreshFunction(0),
-      backgroundFunction(0)
+      directory(directory),
+      stamp(stamp)
     {
     }
 
     ~LuaWidgetFactory()
     {
       unregisterWidget(this);
+      free((void *)name);
+      free((void *)options);
     }
 
     Widget * create(FormGroup * parent, const rect_t & rect, Widget::PersistentData * persistentData, bool init=true) const override
@@ -330,6 +345,10 @@ class LuaWidgetFactory: public WidgetFactory
       if (lsWidgets == 0) return 0;
       initPersistentData(persistentData, init);
 
+      if (!loaded) {
+        loadScript();
+      }
+
       luaSetInstructionsLimit(lsWidgets, MAX_INSTRUCTIONS);
       lua_rawgeti(lsWidgets, LUA_REGISTRYINDEX, createFunction);
 
@@ -368,10 +387,15 @@ class LuaWidgetFactory: public WidgetFactory
     }
 
   protected:
-    int createFunction;
-    int updateFunction;
-    int refreshFunction;
-    int backgroundFunction;
+    std::string directory;
+    LuaWidgetStamp stamp;
+    mutable bool loaded = false;
+    mutable int createFunction = 0;
+    mutable int updateFunction = 0;
+    mutable int refreshFunction = 0;
+    mutable int backgroundFunction = 0;
+
+    void loadScript() const;
 };
 
 // Look for a slot in the event buffer that is either unused (zero) or matches event
@@ -651,51 +675,61 @@ bool LuaWidget::onTouchSlide(coord_t x, coord_t y, coord_t startX, coord_t start
 }
 #endif
 
+struct LuaWidgetScript
+{
+  const char * name;
+  int options;
+  int createFunction;
+  int updateFunction;
+  int refreshFunction;
+  int backgroundFunction;
+};
+
+static LuaWidgetScript luaWidgetScript;
+
+static void luaUnrefWidgetScript()
+{
+  for (int ref: {luaWidgetScript.options, luaWidgetScript.createFunction, luaWidgetScript.updateFunction,
+                 luaWidgetScript.refreshFunction, luaWidgetScript.backgroundFunction}) {
+    if (ref)
+      luaL_unref(lsWidgets, LUA_REGISTRYINDEX, ref);
+  }
+  memclear(&luaWidgetScript, sizeof(luaWidgetScript));
+}
+
 void luaLoadWidgetCallback()
 {
   TRACE("luaLoadWidgetCallback()");
-  const char * name=NULL;
-  int widgetOptions=0, createFunction=0, updateFunction=0, refreshFunction=0, backgroundFunction=0;
+  LuaWidgetScript & script = luaWidgetScript;
 
   luaL_checktype(lsWidgets, -1, LUA_TTABLE);
 
   for (lua_pushnil(lsWidgets); lua_next(lsWidgets, -2); lua_pop(lsWidgets, 1)) {
     const char * key = lua_tostring(lsWidgets, -2);
     if (!strcmp(key, "name")) {
-      name = luaL_checkstring(lsWidgets, -1);
+      script.name = luaL_checkstring(lsWidgets, -1);
     }
     else if (!strcmp(key, "options")) {
-      widgetOptions = luaL_ref(lsWidgets, LUA_REGISTRYINDEX);
+      script.options = luaL_ref(lsWidgets, LUA_REGISTRYINDEX);
       lua_pushnil(lsWidgets);
     }
     else if (!strcmp(key, "create")) {
-      createFunction = luaL_ref(lsWidgets, LUA_REGISTRYINDEX);
+      script.createFunction = luaL_ref(lsWidgets, LUA_REGISTRYINDEX);
       lua_pushnil(lsWidgets);
     }
     else if (!strcmp(key, "update")) {
-      updateFunction = luaL_ref(lsWidgets, LUA_REGISTRYINDEX);
+      script.updateFunction = luaL_ref(lsWidgets, LUA_REGISTRYINDEX);
       lua_pushnil(lsWidgets);
     }
     else if (!strcmp(key, "refresh")) {
-      refreshFunction = luaL_ref(lsWidgets, LUA_REGISTRYINDEX);
+      script.refreshFunction = luaL_ref(lsWidgets, LUA_REGISTRYINDEX);
       lua_pushnil(lsWidgets);
     }
     else if (!strcmp(key, "background")) {
-      backgroundFunction = luaL_ref(lsWidgets, LUA_REGISTRYINDEX);
+      script.backgroundFunction = luaL_ref(lsWidgets, LUA_REGISTRYINDEX);
       lua_pushnil(lsWidgets);
     }
   }
-
-  if (name && createFunction) {
-    ZoneOption * options = createOptionsArray(widgetOptions, MAX_WIDGET_OPTIONS);
-    if (options) {
-      LuaWidgetFactory * factory = new LuaWidgetFactory(name, options, createFunction);
-      factory->updateFunction = updateFunction;
-      factory->refreshFunction = refreshFunction;
-      factory->backgroundFunction = backgroundFunction;   // NOSONAR
-      TRACE("Loaded Lua widget %s", name);
-    }
-  }
 }
 
 void luaLoadFile(const char * filename, void (*callback)())
@@ -720,44 +754,344 @@ void luaLoadFile(const char * filename, void (*callback)())
   else {
     // error while loading Lua widget/theme,
     // do not disable whole Lua state, just ingnore bad widget/theme
-    return;
+    TRACE("luaLoadFile(%s): panic", filename);
   }
   UNPROTECT_LUA();
 }
 
-void luaLoadFiles(const char * directory, void (*callback)())
+static void getWidgetScriptPath(char * path, const char * directory)
 {
-  char path[LUA_FULLPATH_MAXLEN+1];
-  FILINFO fno;
-  DIR dir;
+  strAppend(strAppend(strAppend(path, WIDGETS_PATH PATH_SEPARATOR), directory), LUA_WIDGET_FILENAME);
+}
 
-  strcpy(path, directory);
-  TRACE("luaLoadFiles() %s", path);
-
-  FRESULT res = f_opendir(&dir, path);        /* Open the directory */
-
-  if (res == FR_OK) {
-    int pathlen = strlen(path);
-    path[pathlen++] = '/';
-    for (;;) {
-      res = f_readdir(&dir, &fno);                   /* Read a directory item */
-      if (res != FR_OK || fno.fname[0] == 0) break;  /* Break on error or end of dir */
-      uint8_t len = strlen(fno.fname);
-      if (len > 0 && (unsigned int)(len + pathlen + sizeof(LUA_WIDGET_FILENAME)) <= sizeof(path) &&
-          fno.fname[0]!='.' && (fno.fattrib & AM_DIR)) {
-        strcpy(&path[pathlen], fno.fname);
-        strcat(&path[pathlen], LUA_WIDGET_FILENAME);
-        if (isFileAvailable(path)) {
-          luaLoadFile(path, callback);
-        }
+void LuaWidgetFactory::loadScript() const
+{
+  char path[LUA_FULLPATH_MAXLEN + 1];
+  getWidgetScriptPath(path, directory.c_str());
+
+  memclear(&luaWidgetScript, sizeof(luaWidgetScript));
+  luaLoadFile(path, luaLoadWidgetCallback);
+
+  createFunction = luaWidgetScript.createFunction;
+  updateFunction = luaWidgetScript.updateFunction;
+  refreshFunction = luaWidgetScript.refreshFunction;
+  backgroundFunction = luaWidgetScript.backgroundFunction;   // NOSONAR
+  if (luaWidgetScript.options)
+    luaL_unref(lsWidgets, LUA_REGISTRYINDEX, luaWidgetScript.options);
+  memclear(&luaWidgetScript, sizeof(luaWidgetScript));
+
+  // the options are those of the cache, a failed load shows in create()
+  loaded = true;
+  TRACE("Loaded Lua widget %s", name);
+}
+
+// Copies the options and their names into a single block, independent of
+// the Lua state
+static ZoneOption * copyOptions(const ZoneOption * options)
+{
+  unsigned count = 0;
+  size_t size = 0;
+  for (const ZoneOption * option = options; option->name; option++) {
+    count++;
+    size += strlen(option->name) + 1;
+  }
+
+  ZoneOption * result = (ZoneOption *)malloc(sizeof(ZoneOption) * (count + 1) + size);
+  if (!result) {
+    return nullptr;
+  }
+
+  char * names = (char *)&result[count + 1];
+  for (unsigned i = 0; i < count; i++) {
+    result[i] = options[i];
+    result[i].name = names;
+    names = strAppend(names, options[i].name) + 1;
+  }
+  result[count].name = nullptr; // sentinel
+  return result;
+}
+
+static void luaRegisterWidget(const char * name, const ZoneOption * options, const char * directory, const LuaWidgetStamp & stamp)
+{
+  char * widgetName = strdup(name);
+  ZoneOption * widgetOptions = copyOptions(options);
+  if (!widgetName || !widgetOptions) {
+    free(widgetName);
+    free(widgetOptions);
+    return;
+  }
+  new LuaWidgetFactory(widgetName, widgetOptions, directory, stamp);
+}
+
+// Runs the script once to get its name and options, the functions are
+// released right away as most widgets are not used on the screens
+static bool luaDiscoverWidget(const char * directory, const LuaWidgetStamp & stamp)
+{
+  char path[LUA_FULLPATH_MAXLEN + 1];
+  getWidgetScriptPath(path, directory);
+
+  memclear(&luaWidgetScript, sizeof(luaWidgetScript));
+  luaLoadFile(path, luaLoadWidgetCallback);
+
+  bool result = false;
+  if (luaWidgetScript.name && luaWidgetScript.createFunction) {
+    ZoneOption * options = createOptionsArray(luaWidgetScript.options, MAX_WIDGET_OPTIONS);
+    if (options) {
+      luaRegisterWidget(luaWidgetScript.name, options, directory, stamp);
+      free(options);
+      result = true;
+      TRACE("Discovered Lua widget %s", luaWidgetScript.name);
+    }
+  }
+
+  luaUnrefWidgetScript();
+  return result;
+}
+
+/*
+  The widgets cache (WIDGETS/widgets.cache) describes the widgets found at
+  the last scan, so that they are registered without running their scripts:
+
+    header: "WDG" LUA_WIDGETS_CACHE_VERSION, uint8_t sizeof(ZoneOptionValue), uint8_t count
+    widget: LuaWidgetStamp, string directory, string name, uint8_t options count
+    option: string name, uint8_t type, ZoneOptionValue deflt, min, max
+
+  where strings are a uint8_t length followed by the zero terminated chars.
+  A widget is scanned again when its directory or main.lua changes. The
+  directories whose script failed to load are cached with an empty name and
+  no options, so that they are not run again at each start.
+*/
+
+#define LUA_WIDGETS_CACHE          WIDGETS_PATH PATH_SEPARATOR "widgets.cache"
+#define LUA_WIDGETS_CACHE_VERSION  '1'
+#define LUA_WIDGETS_CACHE_MAX_SIZE 16384
+
+struct LuaCachedWidget
+{
+  LuaWidgetStamp stamp;
+  const char * directory;
+  const char * name;
+  ZoneOption options[MAX_WIDGET_OPTIONS + 1];
+};
+
+class LuaWidgetsCacheReader
+{
+  public:
+    LuaWidgetsCacheReader(const uint8_t * data, size_t size):
+      pos(data),
+      end(data + size)
+    {
+    }
+
+    bool read(void * value, size_t size)
+    {
+      if (size_t(end - pos) < size)
+        return false;
+      memcpy(value, pos, size);
+      pos += size;
+      return true;
+    }
+
+    const char * readString()
+    {
+      uint8_t len;
+      if (!read(&len, 1) || len == 0 || size_t(end - pos) < len || pos[len - 1] != '\0')
+        return nullptr;
+      const char * result = (const char *)pos;
+      pos += len;
+      return result;
+    }
+
+    bool readWidget(LuaCachedWidget & widget)
+    {
+      uint8_t count, type;
+      if (!read(&widget.stamp, sizeof(widget.stamp)) ||
+          !(widget.directory = readString()) ||
+          !(widget.name = readString()) ||
+          !read(&count, 1) || count > MAX_WIDGET_OPTIONS)
+        return false;
+      for (uint8_t i = 0; i < count; i++) {
+        ZoneOption & option = widget.options[i];
+        if (!(option.name = readString()) ||
+            !read(&type, 1) ||
+            !read(&option.deflt, sizeof(ZoneOptionValue)) ||
+            !read(&option.min, sizeof(ZoneOptionValue)) ||
+            !read(&option.max, sizeof(ZoneOptionValue)))
+          return false;
+        option.type = (ZoneOption::Type)type;
       }
+      widget.options[count].name = nullptr;
+      return true;
     }
+
+  protected:
+    const uint8_t * pos;
+    const uint8_t * end;
+};
+
+static uint8_t * luaReadWidgetsCache(size_t & size)
+{
+  FIL file;
+  if (f_open(&file, LUA_WIDGETS_CACHE, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+    return nullptr;
+
+  size = f_size(&file);
+  uint8_t * data = nullptr;
+  if (size >= 6 && size <= LUA_WIDGETS_CACHE_MAX_SIZE)
+    data = (uint8_t *)malloc(size);
+
+  UINT read;
+  if (data && (f_read(&file, data, size, &read) != FR_OK || read != size ||
+               memcmp(data, "WDG", 3) || data[3] != LUA_WIDGETS_CACHE_VERSION ||
+               data[4] != sizeof(ZoneOptionValue))) {
+    TRACE("Lua widgets cache invalid");
+    free(data);
+    data = nullptr;
   }
-  else {
-    TRACE("f_opendir(%s) failed, code=%d", path, res);
+
+  f_close(&file);
+  return data;
+}
+
+static bool luaFindCachedWidget(const uint8_t * data, size_t size, const char * directory,
+                                const LuaWidgetStamp & stamp, LuaCachedWidget & widget)
+{
+  LuaWidgetsCacheReader reader(data + 6, size - 6);
+  for (uint8_t count = data[5]; count > 0; count--) {
+    if (!reader.readWidget(widget))
+      return false;
+    if (!strcmp(widget.directory, directory))
+      return !memcmp(&widget.stamp, &stamp, sizeof(stamp));
+  }
+  return false;
+}
+
+static void appendString(std::string & data, const char * s)
+{
+  data += char(strlen(s) + 1);
+  data.append(s, strlen(s) + 1);
+}
+
+static void appendWidget(std::string & data, const LuaWidgetStamp & stamp, const char * directory,
+                         const char * name, const ZoneOption * options)
+{
+  data.append((const char *)&stamp, sizeof(stamp));
+  appendString(data, directory);
+  appendString(data, name);
+  size_t countPos = data.size();
+  data += char(0);
+  for (const ZoneOption * option = options; option && option->name; option++) {
+    appendString(data, option->name);
+    data += char(option->type);
+    data.append((const char *)&option->deflt, sizeof(ZoneOptionValue));
+    data.append((const char *)&option->min, sizeof(ZoneOptionValue));
+    data.append((const char *)&option->max, sizeof(ZoneOptionValue));
+    data[countPos]++;
+  }
+}
+
+// failed holds the failedCount entries of the widgets which could not be loaded
+void luaWriteWidgetsCache(const std::string & failed, uint8_t failedCount)
+{
+  std::string data("WDG");
+  data += LUA_WIDGETS_CACHE_VERSION;
+  data += char(sizeof(ZoneOptionValue));
+  data += char(0);
+  data += failed;
+
+  uint8_t count = failedCount;
+  for (auto w: getRegisteredWidgets()) {
+    auto factory = dynamic_cast<const LuaWidgetFactory *>(w);
+    if (!factory || count == 255 || factory->directory.size() > 254 || strlen(factory->name) > 254)
+      continue;
+
+    appendWidget(data, factory->stamp, factory->directory.c_str(), factory->name, factory->options);
+    count++;
+  }
+  data[5] = count;
+
+  FIL file;
+  UINT written;
+  if (f_open(&file, LUA_WIDGETS_CACHE, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+    return;
+  if (f_write(&file, data.data(), data.size(), &written) != FR_OK || written != data.size()) {
+    // a truncated cache is rejected at the next scan
+    TRACE("Lua widgets cache write error");
+  }
+  f_close(&file);
+}
+
+static void luaLoadWidgets()
+{
+  char path[LUA_FULLPATH_MAXLEN+1];
+  FILINFO fno, script;
+  DIR dir;
+
+  TRACE("luaLoadWidgets()");
+
+  FRESULT res = f_opendir(&dir, WIDGETS_PATH);
+  if (res != FR_OK) {
+    TRACE("f_opendir(%s) failed, code=%d", WIDGETS_PATH, res);
+    return;
+  }
+
+  size_t cacheSize = 0;
+  uint8_t * cache = luaReadWidgetsCache(cacheSize);
+  LuaCachedWidget cachedWidget;
+  uint8_t cachedCount = cache ? cache[5] : 0;
+  uint8_t count = 0;
+  std::string failed;
+  uint8_t failedCount = 0;
+  bool changed = false;
+
+  for (;;) {
+    res = f_readdir(&dir, &fno);                   /* Read a directory item */
+    if (res != FR_OK || fno.fname[0] == 0) break;  /* Break on error or end of dir */
+    uint8_t len = strlen(fno.fname);
+    if (len == 0 || (unsigned int)(len + sizeof(WIDGETS_PATH) + sizeof(LUA_WIDGET_FILENAME)) > sizeof(path) ||
+        fno.fname[0] == '.' || !(fno.fattrib & AM_DIR))
+      continue;
+
+    getWidgetScriptPath(path, fno.fname);
+    if (f_stat(path, &script) != FR_OK)
+      continue;
+
+    LuaWidgetStamp stamp;
+    stamp.dirDate = fno.fdate;
+    stamp.dirTime = fno.ftime;
+    stamp.fileDate = script.fdate;
+    stamp.fileTime = script.ftime;
+    stamp.fileSize = script.fsize;
+
+    bool found = false;
+    if (cache && luaFindCachedWidget(cache, cacheSize, fno.fname, stamp, cachedWidget)) {
+      found = cachedWidget.name[0] != '\0';
+      if (found)
+        luaRegisterWidget(cachedWidget.name, cachedWidget.options, fno.fname, stamp);
+    }
+    else {
+      TRACE("Lua widget %s not in cache", fno.fname);
+      found = luaDiscoverWidget(fno.fname, stamp);
+      changed = true;
+    }
+
+    if (!found && len < 255 && failedCount < 255) {
+      appendWidget(failed, stamp, fno.fname, "", nullptr);
+      failedCount++;
+    }
+    count++;
   }
 
   f_closedir(&dir);
+  free(cache);
+
+  // the widgets removed since the last scan
+  if (count != cachedCount)
+    changed = true;
+
+  if (changed) {
+    luaWriteWidgetsCache(failed, failedCount);
+  }
 }
 
 #if defined(LUA_ALLOCATOR_TRACER)
@@ -798,8 +1132,7 @@ void luaInitThemesAndWidgets()
     }
     UNPROTECT_LUA();
     TRACE("lsWidgets %p", lsWidgets);
-    //luaLoadFiles(THEMES_PATH, luaLoadThemeCallback);
-    luaLoadFiles(WIDGETS_PATH, luaLoadWidgetCallback);
+    luaLoadWidgets();
     luaDoGc(lsWidgets, true);
   }
 }
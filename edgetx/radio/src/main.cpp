@@ -26,6 +26,10 @@
   #include "libopenui.h"
 #endif
 
+#if defined(USB_SERIAL) && !defined(CLI)
+  #include "io/usb_serial_cmd.h"
+#endif
+
 uint8_t currentSpeakerVolume = 255;
 uint8_t requiredSpeakerVolume = 255;
 uint8_t currentBacklightBright = 0;
@@ -353,7 +357,9 @@ void guiMain(event_t evt)
   DEBUG_TIMER_START(debugTimerLua);
 
   // Run Lua scripts first that don't use LCD
+  EVENT_TRACE_BEGIN(EVENT_TRACE_LUA, 0);
   luaTask(  0, false);
+  EVENT_TRACE_END(EVENT_TRACE_LUA);
 
   // This is run from StandaloneLuaWindow::checkEvents()
   // luaTask(evt, RUN_STNDAL_SCRIPT, true);
@@ -415,7 +421,9 @@ void guiMain(event_t evt)
   }
 
   // run Lua scripts that don't use LCD (to use CPU time while LCD DMA is running)
+  EVENT_TRACE_BEGIN(EVENT_TRACE_LUA, 0);
   luaTask(0, false);
+  EVENT_TRACE_END(EVENT_TRACE_LUA);
 
   t0 = get_tmr10ms() - t0;
   if (t0 > maxLuaDuration) {
@@ -491,6 +499,18 @@ void perMain()
 
   checkTrainerSettings();
   periodicTick();
+
+#if defined(DISK_CACHE)
+  diskCache.checkFlush();
+#endif
+
+#if defined(USB_SERIAL) && !defined(CLI)
+  usbSerialCmdProcess();
+#endif
+
+#if defined(EVENT_TRACE)
+  eventTraceFlush();
+#endif
   DEBUG_TIMER_STOP(debugTimerPerMain1);
 
   if (mainRequestFlags & (1u << REQUEST_FLIGHT_RESET)) {
@@ -201,6 +201,31 @@ void applyExpos(int16_t * anas, uint8_t mode, uint8_t ovwrIdx, int16_t ovwrValue
   }
 }
 
+#if defined(OVERRIDE_CHANNEL_FUNCTION)
+static int16_t channelRuntimeValues[MAX_OUTPUT_CHANNELS];
+static uint32_t channelRuntimeMask;
+
+static_assert(MAX_OUTPUT_CHANNELS <= 32, "channelRuntimeMask too small");
+
+void setChannelRuntimeValues(uint8_t first, const int16_t * values, uint8_t count)
+{
+  for (uint8_t i = 0; i < count && first + i < MAX_OUTPUT_CHANNELS; i++) {
+    channelRuntimeValues[first + i] = limit<int16_t>(-RESX, values[i], RESX);
+    channelRuntimeMask |= 1u << (first + i);
+  }
+}
+
+void clearChannelRuntimeValues()
+{
+  channelRuntimeMask = 0;
+}
+
+bool isChannelRuntimeValue(uint8_t channel)
+{
+  return channelRuntimeMask & (1u << channel);
+}
+#endif
+
 // #define PREVENT_ARITHMETIC_OVERFLOW
 // because of optimizations the reserves before overruns occurs is only the half
 // this defines enables some checks the greatly improves this situation
@@ -227,6 +252,10 @@ int16_t applyLimits(uint8_t channel, int32_t value)
     // safety channel available for channel check
     return calc100toRESX(safetyCh[channel]);
   }
+
+  if (isChannelRuntimeValue(channel)) {
+    return channelRuntimeValues[channel];
+  }
 #endif
 
   if (isFunctionActive(FUNCTION_TRAINER_CHANNELS) && IS_TRAINER_INPUT_VALID()) {
@@ -398,7 +427,7 @@ getvalue_t getValue(mixsrc_t i)
 
   else if (i <= MIXSRC_LAST_GVAR) {
 #if defined(GVARS)
-    return GVAR_VALUE(i - MIXSRC_GVAR1, getGVarFlightMode(mixerCurrentFlightMode, i - MIXSRC_GVAR1));
+    return getGVarValue(i - MIXSRC_GVAR1, mixerCurrentFlightMode);
 #else
     return 0;
 #endif
@@ -31,22 +31,36 @@ struct MixerSchedule {
 
   // period in us
   volatile uint16_t period;
+
+  // set by the module heartbeat
+  volatile bool heartbeat;
+
+  // in DWT ticks
+  uint32_t nextFrame;
+  uint32_t lastFrame;
+  uint32_t frameStart;
 };
 
 static MixerSchedule mixerSchedules[NUM_MODULES];
+static MixerSchedulerModuleStats mixerSchedulerStats[NUM_MODULES];
 
+// when the mixer outputs used by the current frames were computed
+static uint32_t mixerOutputsTime;
+
+// The mixer runs at the rate of the fastest module, the slower
+// modules are served every few mixer runs with the latest outputs
 uint16_t getMixerSchedulerPeriod()
 {
-#if defined(HARDWARE_INTERNAL_MODULE)
-  if (mixerSchedules[INTERNAL_MODULE].period) {
-    return mixerSchedules[INTERNAL_MODULE].period;
+  uint16_t period = 0;
+  for (uint8_t moduleIdx = 0; moduleIdx < NUM_MODULES; moduleIdx++) {
+    uint16_t modulePeriod = mixerSchedules[moduleIdx].period;
+    if (modulePeriod && (!period || modulePeriod < period)) {
+      period = modulePeriod;
+    }
   }
-#endif
-#if defined(HARDWARE_EXTERNAL_MODULE)
-  if (mixerSchedules[EXTERNAL_MODULE].period) {
-    return mixerSchedules[EXTERNAL_MODULE].period;
+  if (period) {
+    return period;
   }
-#endif
 #if defined(STM32) && !defined(SIMU)
   if (getSelectedUsbMode() == USB_JOYSTICK_MODE) {
     return MIXER_SCHEDULER_JOYSTICK_PERIOD_US;
@@ -55,9 +69,87 @@ uint16_t getMixerSchedulerPeriod()
   return MIXER_SCHEDULER_DEFAULT_PERIOD_US;
 }
 
+bool mixerSchedulerHasMultipleRates()
+{
+  uint16_t period = 0;
+  for (uint8_t moduleIdx = 0; moduleIdx < NUM_MODULES; moduleIdx++) {
+    uint16_t modulePeriod = mixerSchedules[moduleIdx].period;
+    if (modulePeriod) {
+      if (period && period != modulePeriod)
+        return true;
+      period = modulePeriod;
+    }
+  }
+  return false;
+}
+
+uint8_t mixerSchedulerGetDueModules()
+{
+  uint32_t now = ticksNow();
+  uint16_t mixerPeriod = getMixerSchedulerPeriod();
+
+  // A slower module is served by the mixer run closest to its own frame
+  // time, and never twice within less than its period minus one mixer run.
+  int32_t tolerance = mixerPeriod * SYSTEM_TICKS_1US / 2;
+
+  mixerOutputsTime = now;
+
+  uint8_t mask = 0;
+  for (uint8_t moduleIdx = 0; moduleIdx < NUM_MODULES; moduleIdx++) {
+    MixerSchedule & schedule = mixerSchedules[moduleIdx];
+    if (schedule.heartbeat) {
+      // the module asked for its frame, the next ones follow its heartbeat
+      schedule.heartbeat = false;
+      schedule.nextFrame = now;
+      mask |= 1 << moduleIdx;
+    }
+    else if (schedule.period <= mixerPeriod ||
+        ((int32_t)(now - schedule.nextFrame) > -tolerance &&
+         now - schedule.lastFrame > uint32_t(schedule.period - mixerPeriod) * SYSTEM_TICKS_1US)) {
+      mask |= 1 << moduleIdx;
+    }
+  }
+
+  return mask;
+}
+
+void mixerSchedulerFrameBegin(uint8_t moduleIdx)
+{
+  mixerSchedules[moduleIdx].frameStart = ticksNow();
+}
+
+void mixerSchedulerFrameEnd(uint8_t moduleIdx)
+{
+  uint32_t now = ticksNow();
+  MixerSchedule & schedule = mixerSchedules[moduleIdx];
+  MixerSchedulerModuleStats & stats = mixerSchedulerStats[moduleIdx];
+
+  stats.buildTime = (now - schedule.frameStart) / SYSTEM_TICKS_1US;
+  stats.outputAge = (now - mixerOutputsTime) / SYSTEM_TICKS_1US;
+  stats.interval = min<uint32_t>((now - schedule.lastFrame) / SYSTEM_TICKS_1US, UINT16_MAX);
+  stats.lastUpdate = get_tmr10ms();
+  schedule.lastFrame = now;
+
+  // The next frame is due one period after this one was due, so that the
+  // module keeps its own rate on average. The period has just been updated
+  // by the frame setup (telemetry synchronization).
+  int32_t period = schedule.period * SYSTEM_TICKS_1US;
+  int32_t late = now - schedule.nextFrame;
+  if (late > period || late < -period) {
+    schedule.nextFrame = now;
+  }
+  schedule.nextFrame += period;
+}
+
+const MixerSchedulerModuleStats & mixerSchedulerGetModuleStats(uint8_t moduleIdx)
+{
+  return mixerSchedulerStats[moduleIdx];
+}
+
 void mixerSchedulerInit()
 {
   memset(mixerSchedules, 0, sizeof(mixerSchedules));
+  memset(mixerSchedulerStats, 0, sizeof(mixerSchedulerStats));
 }
 
 void mixerSchedulerSetPeriod(uint8_t moduleIdx, uint16_t periodUs)
@@ -93,6 +185,19 @@ bool mixerSchedulerWaitForTrigger(uint8_t timeoutMs)
   }
 }
 
+void mixerSchedulerISRHeartbeat(uint8_t moduleIdx)
+{
+  MixerSchedule & schedule = mixerSchedules[moduleIdx];
+  if (schedule.period > getMixerSchedulerPeriod()) {
+    // a faster module drives the mixer timer
+    schedule.heartbeat = true;
+    return;
+  }
+
+  mixerSchedulerResetTimer();
+  mixerSchedulerISRTrigger();
+}
+
 void mixerSchedulerISRTrigger()
 {
   BaseType_t xHigherPriorityTaskWoken = pdFALSE;
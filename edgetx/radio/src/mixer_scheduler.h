@@ -28,6 +28,20 @@
 #define MIN_REFRESH_RATE      1750 /* us */
 #define MAX_REFRESH_RATE     50000 /* us */
 
+// Frame statistics of a module, in us
+struct MixerSchedulerModuleStats {
+  uint16_t interval;    // between the last two frames
+  uint16_t buildTime;   // to build and send the last frame
+  uint16_t outputAge;   // from the mixer outputs to the last frame sent
+  tmr10ms_t lastUpdate;
+
+  bool isValid() const
+  {
+    // 1 second
+    return get_tmr10ms() - lastUpdate < 100;
+  }
+};
+
 #if !defined(SIMU)
 
 // Call once to initialize the mixer scheduler
@@ -63,6 +77,24 @@ uint16_t getMixerSchedulerPeriod();
 // Trigger mixer from an ISR
 void mixerSchedulerISRTrigger();
 
+// Called from the module heartbeat ISR: the heartbeat of the fastest
+// module starts a mixer run, a slower module is marked due for the next one
+void mixerSchedulerISRHeartbeat(uint8_t moduleIdx);
+
+// True if the modules don't run at the same rate
+bool mixerSchedulerHasMultipleRates();
+
+// Returns the mask of the modules due for a new frame with the outputs
+// of the mixer run which just completed. The fastest module gets a frame
+// on each run, the slower ones hold the outputs until their next frame.
+uint8_t mixerSchedulerGetDueModules();
+
+// To be called around the frame building of each module
+void mixerSchedulerFrameBegin(uint8_t moduleIdx);
+void mixerSchedulerFrameEnd(uint8_t moduleIdx);
+
+const MixerSchedulerModuleStats & mixerSchedulerGetModuleStats(uint8_t moduleIdx);
+
 #else
 
 #define mixerSchedulerInit()
@@ -83,6 +115,12 @@ static inline bool mixerSchedulerWaitForTrigger(uint8_t timeout)
 
 #define getMixerSchedulerPeriod() (MIXER_SCHEDULER_DEFAULT_PERIOD_US)
 #define mixerSchedulerISRTrigger()
+#define mixerSchedulerISRHeartbeat(m)
+
+#define mixerSchedulerHasMultipleRates() (false)
+#define mixerSchedulerGetDueModules() ((1 << NUM_MODULES) - 1)
+#define mixerSchedulerFrameBegin(m)
+#define mixerSchedulerFrameEnd(m)
 
 #endif
 
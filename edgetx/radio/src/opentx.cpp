@@ -1076,6 +1076,7 @@ void getADC()
   if (!adcRead())
       TRACE("adcRead failed");
   DEBUG_TIMER_STOP(debugTimerAdcRead);
+  LATENCY_PROBE_ADC();
 
   for (uint8_t x=0; x<NUM_ANALOGS; x++) {
     uint32_t v;
@@ -1270,6 +1271,8 @@ void doMixerCalculations()
   // therefore forget the exact calculation and use only 1 instead; good compromise
   lastTMR = tmr10ms;
 
+  LATENCY_PROBE_MIXER_START();
+
   DEBUG_TIMER_START(debugTimerGetAdc);
   getADC();
   DEBUG_TIMER_STOP(debugTimerGetAdc);
@@ -1283,6 +1286,8 @@ void doMixerCalculations()
   DEBUG_TIMER_START(debugTimerEvalMixes);
   evalMixes(tick10ms);
   DEBUG_TIMER_STOP(debugTimerEvalMixes);
+
+  LATENCY_PROBE_MIXER_END();
 }
 
 void doMixerPeriodicUpdates()
@@ -230,6 +230,8 @@
 #endif
 
 #include "debug.h"
+#include "event_trace.h"
+#include "latency_probe.h"
 
 #if defined(PCBFRSKY) || defined(PCBFLYSKY)
   #define SWSRC_THR                    SWSRC_SB2
@@ -733,10 +733,7 @@ void setupPulsesAFHDS2()
 // {
 //     if (USB_SERIAL_MODE != getSelectedUsbMode()) return;
 //     buffer[0] = HALL_PROTOLO_HEAD;
-//     for (uint32_t idx = 0; idx < size; idx++)
-//     {
 // #if !defined(SIMU)
-//         usbSerialPutc(buffer[idx]);
+//     usbSerialWrite(buffer, size);
 // #endif
-//     }
 // }
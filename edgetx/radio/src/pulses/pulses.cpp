@@ -119,6 +119,21 @@ void getModuleSyncStatusString(uint8_t moduleIdx, char * statusText)
 #if defined(AFHDS3)
   if (moduleIdx == EXTERNAL_MODULE && isModuleAFHDS3(moduleIdx)) {
     extmodulePulsesData.afhds3.getPowerStatus(statusText);
+    return;
+  }
+#endif
+#if !defined(SIMU)
+  // age of the outputs when the modules don't run at the same rate
+  const MixerSchedulerModuleStats & stats = mixerSchedulerGetModuleStats(moduleIdx);
+  if (mixerSchedulerHasMultipleRates() && stats.isValid()) {
+    char * tmp = statusText + strlen(statusText);
+    if (tmp != statusText) {
+      *tmp++ = ' ';
+    }
+    tmp = strAppend(tmp, STR_OUTPUT_AGE);
+    *tmp++ = ' ';
+    tmp = strAppendUnsigned(tmp, stats.outputAge);
+    strAppend(tmp, STR_US);
   }
 #endif
 }
@@ -744,6 +759,8 @@ void intmoduleSendNextFrame()
   } break;
 #endif
   }
+
+  LATENCY_PROBE_FRAME(INTERNAL_MODULE);
 }
 
 bool setupPulsesInternalModule()
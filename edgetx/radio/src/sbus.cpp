@@ -60,6 +60,7 @@ void processSbusFrame(uint8_t * sbus, int16_t * pulses, uint32_t size)
   }
 
   ppmInputValidityTimer = PPM_IN_VALID_TIMEOUT;
+  LATENCY_PROBE_INPUT();
 }
 
 void processSbusInput()
@@ -27,18 +27,23 @@
 
 #define PRINTF_BUFFER_SIZE    128
 
-void serialPutc(char c) {
+void serialWrite(const char * buf, size_t len)
+{
 #if !defined(BOOT) && defined(USB_SERIAL)
   if (getSelectedUsbMode() == USB_SERIAL_MODE)
-    usbSerialPutc(c);
+    usbSerialWrite((const uint8_t *)buf, len);
 #endif
 #if defined(AUX_SERIAL)
-  if (auxSerialTracesEnabled())
-    auxSerialPutc(c);
+  if (auxSerialTracesEnabled()) {
+    for (size_t i = 0; i < len; i++)
+      auxSerialPutc(buf[i]);
+  }
 #endif
 #if defined(AUX2_SERIAL)
-  if (aux2SerialTracesEnabled())
-    aux2SerialPutc(c);
+  if (aux2SerialTracesEnabled()) {
+    for (size_t i = 0; i < len; i++)
+      aux2SerialPutc(buf[i]);
+  }
 #endif
 }
 
@@ -52,14 +57,10 @@ void serialPrintf(const char * format, ...)
   tmp[PRINTF_BUFFER_SIZE] = '\0';
   va_end(arglist);
 
-  const char *t = tmp;
-  while (*t) {
-    serialPutc(*t++);
-  }
+  serialWrite(tmp, strlen(tmp));
 }
 
 void serialCrlf()
 {
-  serialPutc('\r');
-  serialPutc('\n');
+  serialWrite("\r\n", 2);
 }
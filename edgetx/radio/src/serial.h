@@ -22,11 +22,13 @@
 #ifndef _SERIAL_H_
 #define _SERIAL_H_
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-void serialPutc(char c);
+void serialWrite(const char * buf, size_t len);
 void serialPrintf(const char *format, ...);
 void serialCrlf();
 
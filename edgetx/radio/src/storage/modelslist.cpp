@@ -31,8 +31,10 @@ using std::list;
 #include "datastructs.h"
 #include "pulses/modules_helpers.h"
 #include "strhelpers.h"
+#include "sdcard_common.h"
 
 #include <cstring>
+#include <cstdlib>
 
 ModelsList modelslist;
 
@@ -131,6 +133,16 @@ void ModelCell::setRfModuleData(uint8_t moduleIdx, ModuleData* modData)
   }
 }
 
+void ModelCell::setModelData(ModelData* model)
+{
+  setModelName(model->header.name);
+#if LEN_BITMAP_NAME > 0
+  strncpy(modelBitmap, model->header.bitmap, LEN_BITMAP_NAME);
+  modelBitmap[LEN_BITMAP_NAME] = '\0';
+#endif
+  setRfData(model);
+}
+
 bool ModelCell::fetchRfData()
 {
 #if !defined(SDCARD_YAML)
@@ -152,6 +164,7 @@ bool ModelCell::fetchRfData()
   if ((f_read(&file, buf, LEN_MODEL_NAME, &read) != FR_OK) || (read != LEN_MODEL_NAME))
     goto error;
 
+  buf[LEN_MODEL_NAME] = '\0';
   setModelName(buf);
 
   // 1. fetch modelId: NUM_MODULES @ offsetof(ModelHeader, modelId)
@@ -160,13 +173,19 @@ bool ModelCell::fetchRfData()
   if ((f_read(&file, modelId, NUM_MODULES, &read) != FR_OK) || (read != NUM_MODULES))
     goto error;
 
+#if LEN_BITMAP_NAME > 0
+  if ((f_read(&file, modelBitmap, LEN_BITMAP_NAME, &read) != FR_OK) || (read != LEN_BITMAP_NAME))
+    goto error;
+  modelBitmap[LEN_BITMAP_NAME] = '\0';
+#endif
+
   // 2. fetch ModuleData: sizeof(ModuleData)*NUM_MODULES @ offsetof(ModelData, moduleData)
   if (f_lseek(&file, start_offset + offsetof(ModelData, moduleData)) != FR_OK)
     goto error;
 
   for(uint8_t i=0; i<NUM_MODULES; i++) {
     ModuleData modData;
-    if ((f_read(&file, &modData, NUM_MODULES, &read) != FR_OK) || (read != NUM_MODULES))
+    if ((f_read(&file, &modData, sizeof(ModuleData), &read) != FR_OK) || (read != sizeof(ModuleData)))
       goto error;
 
     setRfModuleData(i, &modData);
@@ -181,7 +200,17 @@ bool ModelCell::fetchRfData()
   return false;
 
 #else
-  return false;
+  // the modules are far down the file: it has to be parsed in full
+  auto model = (ModelData *)malloc(sizeof(ModelData));
+  if (!model) return false;
+
+  const char * error = readModel(modelFilename, (uint8_t *)model, sizeof(ModelData));
+  if (!error) {
+    setModelData(model);
+  }
+
+  free(model);
+  return !error;
 #endif
 }
 
@@ -333,7 +362,6 @@ bool ModelsList::loadTxt()
           currentCategory = category;
           currentModel = model;
         }
-        model->fetchRfData();
         modelsCount += 1;
       }
     }
@@ -427,6 +455,8 @@ bool ModelsList::load(Format fmt)
     }
   }
 
+  refreshIndex();
+
   loaded = true;
   return res;
 }
@@ -472,7 +502,8 @@ int ModelsList::getCurrentCategoryIdx() const
 void ModelsList::setCurrentModel(ModelCell * cell)
 {
   currentModel = cell;
-  if (!currentModel->valid_rfData)
+  // while loading, the models index is read afterwards
+  if (loaded && !currentModel->valid_rfData)
     currentModel->fetchRfData();
 }
 
@@ -661,3 +692,233 @@ void ModelsList::onNewModelCreated(ModelCell* cell, ModelData* model)
   model->header.modelId[INTERNAL_MODULE] = new_id;
   cell->setModelId(INTERNAL_MODULE, new_id);
 }
+
+//
+// Models index
+//
+// MODELS/models.idx keeps what the models list needs from each model file,
+// so that the files don't have to be opened (or parsed in full with YAML)
+// each time the list is loaded. A record is only used as long as the date,
+// time and size of the model file are the ones it was made from.
+//
+
+#define MODELS_INDEX_VERSION           1
+#define MODELS_INDEX_TMP_EXT           ".tmp"
+
+PACK(struct ModelsIndexHeader {
+  char     magic[3];
+  uint8_t  version;
+  uint16_t recordSize;
+  uint16_t count;
+});
+
+PACK(struct ModelsIndexRecord {
+  char             filename[LEN_MODEL_FILENAME];
+  char             name[LEN_MODEL_NAME];
+  uint8_t          modelId[NUM_MODULES];
+  SimpleModuleData moduleData[NUM_MODULES];
+#if LEN_BITMAP_NAME > 0
+  char             bitmap[LEN_BITMAP_NAME];
+#endif
+  uint16_t         fileDate;
+  uint16_t         fileTime;
+  uint32_t         fileSize;
+});
+
+static void getIndexRecord(ModelsIndexRecord * record, const ModelCell * model)
+{
+  memset(record, 0, sizeof(ModelsIndexRecord));
+  strncpy(record->filename, model->modelFilename, LEN_MODEL_FILENAME);
+  strncpy(record->name, model->modelName, LEN_MODEL_NAME);
+  memcpy(record->modelId, model->modelId, sizeof(record->modelId));
+  memcpy(record->moduleData, model->moduleData, sizeof(record->moduleData));
+#if LEN_BITMAP_NAME > 0
+  strncpy(record->bitmap, model->modelBitmap, LEN_BITMAP_NAME);
+#endif
+  record->fileDate = model->fileDate;
+  record->fileTime = model->fileTime;
+  record->fileSize = model->fileSize;
+}
+
+static void getIndexTmpPath(char * path)
+{
+  strcpy(path, MODELS_INDEX_PATH);
+  strcat(path, MODELS_INDEX_TMP_EXT);
+}
+
+ModelCell * ModelsList::findModel(const char * filename) const
+{
+  for (auto category : categories) {
+    for (auto model : *category) {
+      if (!strcmp(model->modelFilename, filename))
+        return model;
+    }
+  }
+  return nullptr;
+}
+
+void ModelsList::refreshIndex()
+{
+  // 1. stamp the models with a single scan of the directory
+  DIR dir;
+  FILINFO fno;
+  if (f_opendir(&dir, MODELS_PATH) == FR_OK) {
+    while (f_readdir(&dir, &fno) == FR_OK && fno.fname[0] != '\0') {
+      if (fno.fattrib & AM_DIR) continue;
+      ModelCell * model = findModel(fno.fname);
+      if (model) {
+        model->fileDate = fno.fdate;
+        model->fileTime = fno.ftime;
+        model->fileSize = fno.fsize;
+      }
+    }
+    f_closedir(&dir);
+  }
+
+  // 2. take what is still valid from the index
+  char tmpPath[sizeof(MODELS_INDEX_PATH) + sizeof(MODELS_INDEX_TMP_EXT)];
+  getIndexTmpPath(tmpPath);
+
+  FIL file;
+  FRESULT result = f_open(&file, MODELS_INDEX_PATH, FA_OPEN_EXISTING | FA_READ);
+  if (result != FR_OK && f_stat(tmpPath, &fno) == FR_OK) {
+    // power loss while the index was replaced
+    f_rename(tmpPath, MODELS_INDEX_PATH);
+    result = f_open(&file, MODELS_INDEX_PATH, FA_OPEN_EXISTING | FA_READ);
+  }
+
+  unsigned int count = 0;
+  unsigned int valid = 0;
+  if (result == FR_OK) {
+    ModelsIndexHeader header;
+    UINT read;
+    if (f_read(&file, &header, sizeof(header), &read) == FR_OK && read == sizeof(header) &&
+        !memcmp(header.magic, "MDX", sizeof(header.magic)) &&
+        header.version == MODELS_INDEX_VERSION &&
+        header.recordSize == sizeof(ModelsIndexRecord) &&
+        f_size(&file) == sizeof(header) + header.count * sizeof(ModelsIndexRecord)) {
+      count = header.count;
+      for (unsigned int i = 0; i < count; i++) {
+        ModelsIndexRecord record;
+        if (f_read(&file, &record, sizeof(record), &read) != FR_OK || read != sizeof(record))
+          break;
+
+        char filename[LEN_MODEL_FILENAME + 1];
+        strncpy(filename, record.filename, LEN_MODEL_FILENAME);
+        filename[LEN_MODEL_FILENAME] = '\0';
+
+        ModelCell * model = findModel(filename);
+        if (!model || model->valid_rfData || model->fileSize == 0 ||
+            model->fileDate != record.fileDate ||
+            model->fileTime != record.fileTime ||
+            model->fileSize != record.fileSize)
+          continue;
+
+        char name[LEN_MODEL_NAME + 1];
+        strncpy(name, record.name, LEN_MODEL_NAME);
+        name[LEN_MODEL_NAME] = '\0';
+        model->setModelName(name);
+        memcpy(model->modelId, record.modelId, sizeof(record.modelId));
+        memcpy(model->moduleData, record.moduleData, sizeof(record.moduleData));
+#if LEN_BITMAP_NAME > 0
+        strncpy(model->modelBitmap, record.bitmap, LEN_BITMAP_NAME);
+        model->modelBitmap[LEN_BITMAP_NAME] = '\0';
+#endif
+        model->valid_rfData = true;
+        valid++;
+      }
+    }
+    f_close(&file);
+  }
+
+  // 3. and read the models which are not in it
+  bool dirty = (valid != count);
+  for (auto category : categories) {
+    for (auto model : *category) {
+      if (!model->valid_rfData && model->fileSize != 0 && model->fetchRfData())
+        dirty = true;
+    }
+  }
+
+  TRACE("models index: %d/%d records used", valid, count);
+  if (dirty) {
+    writeIndex();
+  }
+}
+
+void ModelsList::writeIndex()
+{
+  char tmpPath[sizeof(MODELS_INDEX_PATH) + sizeof(MODELS_INDEX_TMP_EXT)];
+  getIndexTmpPath(tmpPath);
+
+  FIL file;
+  FRESULT result = f_open(&file, tmpPath, FA_CREATE_ALWAYS | FA_WRITE);
+  if (result != FR_OK) {
+    TRACE("models index: cannot write %s", tmpPath);
+    return;
+  }
+
+  ModelsIndexHeader header;
+  memcpy(header.magic, "MDX", sizeof(header.magic));
+  header.version = MODELS_INDEX_VERSION;
+  header.recordSize = sizeof(ModelsIndexRecord);
+  header.count = 0;
+
+  UINT written;
+  result = f_write(&file, &header, sizeof(header), &written);
+
+  for (auto category : categories) {
+    for (auto model : *category) {
+      if (result != FR_OK) break;
+      if (!model->valid_rfData || model->fileSize == 0) continue;
+
+      ModelsIndexRecord record;
+      getIndexRecord(&record, model);
+      result = f_write(&file, &record, sizeof(record), &written);
+      header.count++;
+    }
+  }
+
+  // the header is completed last
+  if (result == FR_OK) result = f_lseek(&file, 0);
+  if (result == FR_OK) result = f_write(&file, &header, sizeof(header), &written);
+  f_close(&file);
+
+  if (result != FR_OK) {
+    f_unlink(tmpPath);
+    return;
+  }
+
+  f_unlink(MODELS_INDEX_PATH);
+  f_rename(tmpPath, MODELS_INDEX_PATH);
+}
+
+void ModelsList::updateModel(const char * filename, ModelData * model)
+{
+  ModelCell * cell = findModel(filename);
+  if (!cell) return;
+
+  char path[256];
+  getModelPath(path, filename);
+
+  FILINFO fno;
+  if (f_stat(path, &fno) != FR_OK) return;
+
+  ModelsIndexRecord previous;
+  getIndexRecord(&previous, cell);
+  bool was_valid = cell->valid_rfData;
+
+  cell->setModelData(model);
+  cell->fileDate = fno.fdate;
+  cell->fileTime = fno.ftime;
+  cell->fileSize = fno.fsize;
+
+  // appending to the model journal leaves the model file as it is: the
+  // index is then only written if the name, bitmap or RF data changed
+  ModelsIndexRecord current;
+  getIndexRecord(&current, cell);
+  if (was_valid && !memcmp(&previous, &current, sizeof(current)))
+    return;
+
+  writeIndex();
+}
@@ -53,10 +53,19 @@ class ModelCell
     char modelFilename[LEN_MODEL_FILENAME + 1];
     char modelName[LEN_MODEL_NAME + 1] = {};
 
+#if LEN_BITMAP_NAME > 0
+    char modelBitmap[LEN_BITMAP_NAME + 1] = {};
+#endif
+
     bool             valid_rfData;
     uint8_t          modelId[NUM_MODULES];
     SimpleModuleData moduleData[NUM_MODULES];
 
+    // model file stamp, as found in MODELS/ when the index was refreshed
+    uint16_t fileDate = 0;
+    uint16_t fileTime = 0;
+    uint32_t fileSize = 0;
+
     explicit ModelCell(const char * name);
     explicit ModelCell(const char * name, uint8_t len);
     ~ModelCell();
@@ -66,6 +75,7 @@ class ModelCell
     void setModelName(char * name);
     void setModelName(char* name, uint8_t len);
     void setRfData(ModelData * model);
+    void setModelData(ModelData * model);
 
     void setModelId(uint8_t moduleIdx, uint8_t id);
     void setRfModuleData(uint8_t moduleIdx, ModuleData* modData);
@@ -101,6 +111,10 @@ class ModelsList
 
   void init();
 
+  ModelCell * findModel(const char * filename) const;
+  void refreshIndex();
+  void writeIndex();
+
 public:
 
   enum class Format {
@@ -171,6 +185,9 @@ public:
 
   void onNewModelCreated(ModelCell* cell, ModelData* model);
 
+  // Refreshes the index entry of a model just written
+  void updateModel(const char * filename, ModelData * model);
+
 protected:
   FIL file;
 
@@ -43,26 +43,128 @@ RamBackup * ramBackup = &_ramBackup;
 RamBackup * ramBackup = (RamBackup *)BKPSRAM_BASE;
 #endif
 
+#define RAM_BACKUP_CHUNKS \
+  ((sizeof(ramBackupUncompressed) + RAM_BACKUP_CHUNK_SIZE - 1) / RAM_BACKUP_CHUNK_SIZE)
+
+// hash of each chunk as it is in the backup RAM
+static uint32_t ramBackupHashes[RAM_BACKUP_CHUNKS];
+static bool ramBackupHashesValid = false;
+
+static inline unsigned int getChunkSize(unsigned int chunk)
+{
+  return min<unsigned int>(RAM_BACKUP_CHUNK_SIZE, sizeof(ramBackupUncompressed) - chunk * RAM_BACKUP_CHUNK_SIZE);
+}
+
+static inline uint8_t * getChunkData(unsigned int chunk)
+{
+  return (uint8_t *)&ramBackupUncompressed + chunk * RAM_BACKUP_CHUNK_SIZE;
+}
+
+// FNV-1a on 32 bit words. A change limited to one word always changes the
+// hash, other changes are missed with a 2^-32 probability
+static uint32_t getChunkHash(unsigned int chunk)
+{
+  const uint8_t * data = getChunkData(chunk);
+  unsigned int size = getChunkSize(chunk);
+  uint32_t hash = 2166136261u;
+  unsigned int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    uint32_t word;
+    memcpy(&word, &data[i], sizeof(word));
+    hash = (hash ^ word) * 16777619u;
+  }
+  for (; i < size; i++) {
+    hash = (hash ^ data[i]) * 16777619u;
+  }
+  return hash;
+}
+
+static inline uint16_t getStoredChunkSize(unsigned int offset)
+{
+  return ramBackup->data[offset] + (ramBackup->data[offset + 1] << 8);
+}
+
+// Replaces the chunk stored at offset (if any) with the new encoding,
+// moving the following chunks
+static bool writeChunk(unsigned int chunk, unsigned int offset)
+{
+  static uint8_t buffer[RAM_BACKUP_CHUNK_SIZE + RAM_BACKUP_CHUNK_SIZE / 8];
+
+  unsigned int size = compress(buffer, sizeof(buffer), getChunkData(chunk), getChunkSize(chunk));
+  if (size == 0)
+    return false;
+
+  unsigned int oldSize = (offset < ramBackup->size) ? 2 + getStoredChunkSize(offset) : 0;
+  unsigned int total = ramBackup->size - oldSize + 2 + size;
+  if (total > sizeof(ramBackup->data))
+    return false;
+
+  if (oldSize != 2 + size) {
+    memmove(&ramBackup->data[offset + 2 + size], &ramBackup->data[offset + oldSize], ramBackup->size - offset - oldSize);
+  }
+  ramBackup->data[offset] = size;
+  ramBackup->data[offset + 1] = size >> 8;
+  memcpy(&ramBackup->data[offset + 2], buffer, size);
+  ramBackup->size = total;
+  return true;
+}
+
 void rambackupWrite()
 {
   copyRadioData(&ramBackupUncompressed.radio, &g_eeGeneral);
   copyModelData(&ramBackupUncompressed.model, &g_model);
-  ramBackup->size = compress(ramBackup->data, sizeof(ramBackup->data),
-                             (const uint8_t *)&ramBackupUncompressed,
-                             sizeof(ramBackupUncompressed));
 
-  TRACE("RamBackupWrite sdsize=%d backupsize=%d rlcsize=%d",
+  if (!ramBackupHashesValid) {
+    ramBackup->size = 0;
+  }
+
+  unsigned int offset = 0;
+  unsigned int count = 0;
+  for (unsigned int chunk = 0; chunk < RAM_BACKUP_CHUNKS; chunk++) {
+    uint32_t hash = getChunkHash(chunk);
+    if (!ramBackupHashesValid || hash != ramBackupHashes[chunk]) {
+      if (!writeChunk(chunk, offset)) {
+        TRACE("RamBackupWrite failed");
+        ramBackup->size = 0;
+        ramBackupHashesValid = false;
+        return;
+      }
+      ramBackupHashes[chunk] = hash;
+      count++;
+    }
+    offset += 2 + getStoredChunkSize(offset);
+  }
+
+  ramBackupHashesValid = true;
+
+  TRACE("RamBackupWrite sdsize=%d backupsize=%d rlcsize=%d chunks=%d/%d",
         sizeof(ModelData) + sizeof(RadioData),
-        sizeof(Backup::RamBackupUncompressed), ramBackup->size);
+        sizeof(Backup::RamBackupUncompressed), ramBackup->size,
+        count, RAM_BACKUP_CHUNKS);
 }
 
 bool rambackupRestore()
 {
-  if (ramBackup->size == 0)
+  if (ramBackup->size == 0 || ramBackup->size > sizeof(ramBackup->data))
     return false;
 
-  if (uncompress((uint8_t *)&ramBackupUncompressed, sizeof(ramBackupUncompressed), ramBackup->data, ramBackup->size) != sizeof(ramBackupUncompressed))
-    return false;
+  unsigned int offset = 0;
+  for (unsigned int chunk = 0; chunk < RAM_BACKUP_CHUNKS; chunk++) {
+    if (offset + 2 > ramBackup->size)
+      return false;
+    unsigned int size = getStoredChunkSize(offset);
+    if (offset + 2 + size > ramBackup->size)
+      return false;
+    unsigned int chunkSize = getChunkSize(chunk);
+    if (uncompress(getChunkData(chunk), chunkSize, &ramBackup->data[offset + 2], size) != chunkSize)
+      return false;
+    ramBackupHashes[chunk] = getChunkHash(chunk);
+    offset += 2 + size;
+  }
+
+  // the backup RAM matches the restored data, the next write only
+  // re-encodes the chunks modified since
+  ramBackupHashesValid = true;
 
   memset(&g_eeGeneral, 0, sizeof(g_eeGeneral));
   memset(&g_model, 0, sizeof(g_model));
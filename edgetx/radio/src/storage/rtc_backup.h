@@ -24,6 +24,11 @@
 
 #include "definitions.h"
 
+// The backup is split in chunks of RAM_BACKUP_CHUNK_SIZE bytes, each one
+// RLC compressed separately and stored as a 16 bit size followed by the
+// compressed data, so that only the modified chunks are re-encoded
+#define RAM_BACKUP_CHUNK_SIZE          256
+
 PACK(struct RamBackup {
   uint16_t size;
   uint8_t data[4094];
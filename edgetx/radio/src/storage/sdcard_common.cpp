@@ -22,6 +22,9 @@
 #include "opentx.h"
 #include "storage.h"
 #include "sdcard_common.h"
+#if defined(SDCARD_YAML)
+#include "sdcard_yaml.h"
+#endif
 #include "modelslist.h"
 #include "conversions/conversions.h"
 #include "model_init.h"
@@ -86,13 +89,23 @@ void storageCheck(bool immediately)
     }
   }
 
+#if defined(SDCARD_YAML)
+  // the journal is merged before the model file is used elsewhere
+  if ((storageDirtyMsk & EE_MODEL) || (immediately && isModelJournalPending())) {
+#else
   if (storageDirtyMsk & EE_MODEL) {
+#endif
     TRACE("eeprom write model");
     storageDirtyMsk &= ~EE_MODEL;
-    const char * error = writeModel();
+    const char * error = writeModel(immediately);
     if (error) {
       TRACE("writeModel error=%s", error);
     }
+#if defined(STORAGE_MODELSLIST)
+    else {
+      modelslist.updateModel(g_eeGeneral.currModelFilename, &g_model);
+    }
+#endif
   }
 }
 
@@ -52,14 +52,18 @@ const char *loadFileBin(const char *fullpath, uint8_t *data,
 
 // writes a complete YAML file
 struct YamlNode;
-const char* writeFileYaml(const char* path, const YamlNode* root_node, uint8_t* data);
+// writes a complete YAML file, and the hash of its content if asked for
+const char* writeFileYaml(const char* path, const YamlNode* root_node, uint8_t* data,
+                          uint32_t* hash = nullptr);
 
 void getModelPath(char * path, const char * filename);
 
 const char * readModel(const char * filename, uint8_t * buffer, uint32_t size);
 const char * loadModel(char * filename, bool alarms=true);
 const char * createModel();
-const char * writeModel();
+// Without compact, only the parts modified since the last write are
+// appended to the model journal (YAML storage)
+const char * writeModel(bool compact = true);
 
 #if !defined(STORAGE_MODELSLIST)
 
@@ -30,6 +30,7 @@
 #include "yaml/yaml_tree_walker.h"
 #include "yaml/yaml_parser.h"
 #include "yaml/yaml_datastructs.h"
+#include "yaml/yaml_bits.h"
 
 #if defined(EEPROM_RLC)
  #include "storage/eeprom_common.h"
@@ -38,7 +39,19 @@
 
 #include "storage/conversions/conversions.h"
 
-const char * readYamlFile(const char* fullpath, const YamlParserCalls* calls, void* parser_ctx)
+#define YAML_HASH_INIT                 2166136261u
+
+// FNV-1a
+static uint32_t yamlHash(uint32_t hash, const void* data, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+        hash = (hash ^ ((const uint8_t*)data)[i]) * 16777619u;
+    return hash;
+}
+
+// the hash of the file content is returned if asked for
+const char * readYamlFile(const char* fullpath, const YamlParserCalls* calls, void* parser_ctx,
+                          uint32_t* hash = nullptr)
 {
     FIL  file;
     UINT bytes_read;
@@ -51,12 +64,18 @@ const char * readYamlFile(const char* fullpath, const YamlParserCalls* calls, vo
     YamlParser yp; //TODO: move to re-usable buffer
     yp.init(calls, parser_ctx);
 
+    if (hash)
+      *hash = YAML_HASH_INIT;
+
     char buffer[32];
     while (f_read(&file, buffer, sizeof(buffer), &bytes_read) == FR_OK) {
 
       // reached EOF?
       if (bytes_read == 0)
         break;
+
+      if (hash)
+        *hash = yamlHash(*hash, buffer, bytes_read);
       
       if (f_eof(&file)) yp.set_eof();
       if (yp.parse(buffer, bytes_read) != YamlParser::CONTINUE_PARSING)
@@ -144,8 +163,9 @@ const char * loadRadioSettings()
 }
 
 struct yaml_writer_ctx {
-    FIL*    file;
-    FRESULT result;
+    FIL*     file;
+    FRESULT  result;
+    uint32_t hash;
 };
 
 static bool yaml_writer(void* opaque, const char* str, size_t len)
@@ -157,11 +177,12 @@ static bool yaml_writer(void* opaque, const char* str, size_t len)
     TRACE_NOCRLF("%.*s",len,str);
 #endif
 
+    ctx->hash = yamlHash(ctx->hash, str, len);
     ctx->result = f_write(ctx->file, str, len, &bytes_written);
     return (ctx->result == FR_OK) && (bytes_written == len);
 }
 
-const char* writeFileYaml(const char* path, const YamlNode* root_node, uint8_t* data)
+const char* writeFileYaml(const char* path, const YamlNode* root_node, uint8_t* data, uint32_t* hash)
 {
     FIL file;
 
@@ -176,6 +197,7 @@ const char* writeFileYaml(const char* path, const YamlNode* root_node, uint8_t*
     yaml_writer_ctx ctx;
     ctx.file = &file;
     ctx.result = FR_OK;
+    ctx.hash = YAML_HASH_INIT;
     
     if (!tree.generate(yaml_writer, &ctx)) {
         if (ctx.result != FR_OK) {
@@ -185,6 +207,8 @@ const char* writeFileYaml(const char* path, const YamlNode* root_node, uint8_t*
     }
 
     f_close(&file);
+    if (hash)
+        *hash = ctx.hash;
     return NULL;
 }
 
@@ -196,6 +220,350 @@ const char * writeGeneralSettings()
 }
 
 
+//
+// Model journal
+//
+// Saving the model appends the top-level nodes modified since the last
+// write to <model>.yml.jnl instead of rewriting the whole file. The journal
+// is applied on top of the model file when it is loaded, and merged back
+// into it by storageCheck(true), i.e. before the model is changed, the SD
+// card is exported over USB, or the radio is switched off. A journal left
+// behind is merged by the next write of the model, scheduled when it is
+// loaded.
+//
+// The model file itself is always replaced atomically: written to
+// <model>.yml.tmp first, then renamed.
+//
+// The journal starts with the hash of the model file it applies to, so
+// that a journal left behind (power loss after the model file was
+// replaced, deleted model) is dropped instead of being replayed over a
+// newer file.
+//
+
+#define MODEL_JOURNAL_EXT              ".jnl"
+#define MODEL_TMP_EXT                  ".tmp"
+#define MODEL_JOURNAL_MAX_NODES        64
+#define MODEL_JOURNAL_MAX_SIZE         4096
+
+#define MODEL_JOURNAL_MAGIC            0x4C4E4A59 // "YJNL"
+
+PACK(struct ModelJournalHeader {
+    uint32_t magic;
+    uint32_t baseHash;  // hash of the model file content
+});
+
+PACK(struct ModelJournalRecord {
+    uint64_t nodes;   // one bit per top-level node
+    uint16_t size;    // YAML text following
+    uint16_t crc;
+});
+
+static struct {
+    char     path[sizeof(MODELS_PATH) + LEN_MODEL_FILENAME + 1];
+    uint32_t hashes[MODEL_JOURNAL_MAX_NODES];
+    uint32_t baseHash;
+    uint32_t size;
+    bool     valid;
+} modelJournal;
+
+static YamlNode modelJournalNodes[MODEL_JOURNAL_MAX_NODES + 1];
+
+static void getModelJournalPath(char* dst, const char* path, const char* ext)
+{
+    strcpy(dst, path);
+    strcat(dst, ext);
+}
+
+static uint8_t getModelNodesCount()
+{
+    const YamlNode* node = get_modeldata_nodes()->u._array.child;
+    uint8_t count = 0;
+    while (node[count].type != YDT_NONE)
+        count++;
+    return count;
+}
+
+static inline uint32_t getNodeBits(const YamlNode* node)
+{
+    if (node->type == YDT_ARRAY)
+        return node->size * node->u._array.u._a.elmts;
+    return node->size;
+}
+
+// Returns the bits range of a top-level node. Custom nodes have no size,
+// their data is held by the padding which follows, so it is included
+static void getNodeRange(uint8_t idx, uint32_t& start, uint32_t& end)
+{
+    const YamlNode* nodes = get_modeldata_nodes()->u._array.child;
+    start = 0;
+    for (uint8_t i = 0; i < idx; i++)
+        start += getNodeBits(&nodes[i]);
+    end = start + getNodeBits(&nodes[idx]);
+    for (const YamlNode* node = &nodes[idx + 1]; node->type == YDT_PADDING; node++)
+        end += node->size;
+}
+
+static uint32_t getNodeHash(uint8_t idx)
+{
+    uint32_t start, end;
+    getNodeRange(idx, start, end);
+    const uint8_t* data = (const uint8_t*)&g_model;
+    return yamlHash(YAML_HASH_INIT, data + start / 8, (end + 7) / 8 - start / 8);
+}
+
+static void clearNode(uint8_t* data, uint32_t size, uint8_t idx)
+{
+    uint32_t start, end;
+    getNodeRange(idx, start, end);
+    if (end > size * 8)
+        return;
+    while (start < end && (start & 7)) {
+        yaml_put_bits(data, 0, start++, 1);
+    }
+    if (end - start >= 8) {
+        memset(data + start / 8, 0, (end - start) / 8);
+        start += (end - start) & ~7u;
+    }
+    while (start < end) {
+        yaml_put_bits(data, 0, start++, 1);
+    }
+}
+
+static void initModelJournal(const char* path, uint32_t baseHash)
+{
+    uint8_t count = getModelNodesCount();
+    if (count > MODEL_JOURNAL_MAX_NODES || strlen(path) >= sizeof(modelJournal.path)) {
+        modelJournal.valid = false;
+        return;
+    }
+
+    strcpy(modelJournal.path, path);
+    for (uint8_t i = 0; i < count; i++)
+        modelJournal.hashes[i] = getNodeHash(i);
+    modelJournal.baseHash = baseHash;
+    modelJournal.size = 0;
+    modelJournal.valid = true;
+}
+
+bool isModelJournalPending()
+{
+    return modelJournal.valid && modelJournal.size > 0;
+}
+
+static void setModelGVarsDefaults(ModelData* md)
+{
+#if defined(FLIGHT_MODES) && defined(GVARS)
+    // reset GVars to default values
+    // Note: taken from opentx.cpp::modelDefault()
+    //TODO: new func in gvars
+    for (int p=1; p<MAX_FLIGHT_MODES; p++) {
+        for (int i=0; i<MAX_GVARS; i++) {
+            md->flightModeData[p].gvars[i] = GVAR_MAX+1;
+        }
+    }
+#endif
+}
+
+// Applies the journal records on top of the model just read. Returns
+// true if a journal was found
+static bool readModelJournal(const char* path, uint32_t baseHash, uint8_t* buffer, uint32_t size)
+{
+    char journalPath[256];
+    getModelJournalPath(journalPath, path, MODEL_JOURNAL_EXT);
+
+    FIL file;
+    if (f_open(&file, journalPath, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+        return false;
+
+    ModelJournalHeader header;
+    UINT bytes_read;
+    if (f_read(&file, &header, sizeof(header), &bytes_read) != FR_OK
+        || bytes_read != sizeof(header) || header.magic != MODEL_JOURNAL_MAGIC
+        || header.baseHash != baseHash) {
+        TRACE("model journal: not made for this model file, dropped");
+        f_close(&file);
+        f_unlink(journalPath);
+        return false;
+    }
+
+    const YamlNode* nodes = get_modeldata_nodes()->u._array.child;
+    uint8_t count = getModelNodesCount();
+
+    ModelJournalRecord record;
+    char chunk[32];
+
+    while (f_read(&file, &record, sizeof(record), &bytes_read) == FR_OK
+           && bytes_read == sizeof(record) && record.size > 0
+           && f_tell(&file) + record.size <= f_size(&file)) {
+
+        // check the record before using it, the last one may have been
+        // cut by a power loss
+        uint32_t start = f_tell(&file);
+        uint16_t crc = 0;
+        for (uint16_t len = 0; len < record.size; len += bytes_read) {
+            if (f_read(&file, chunk, min<uint16_t>(sizeof(chunk), record.size - len), &bytes_read) != FR_OK
+                || bytes_read == 0)
+                break;
+            crc = crc16(CRC_1021, (const uint8_t*)chunk, bytes_read, crc);
+        }
+        if (crc != record.crc) {
+            TRACE("model journal: bad record");
+            break;
+        }
+
+        // the records contain whole nodes, omitting the default values
+        for (uint8_t i = 0; i < count; i++) {
+            if (record.nodes & ((uint64_t)1 << i)) {
+                clearNode(buffer, size, i);
+                if (!strcmp(nodes[i].tag, "flightModeData") && size == sizeof(ModelData))
+                    setModelGVarsDefaults(reinterpret_cast<ModelData*>(buffer));
+            }
+        }
+
+        YamlTreeWalker tree;
+        tree.reset(size == sizeof(ModelData) ? get_modeldata_nodes() : get_partialmodel_nodes(), buffer);
+
+        YamlParser yp;
+        yp.init(YamlTreeWalker::get_parser_calls(), &tree);
+
+        f_lseek(&file, start);
+        for (uint16_t len = 0; len < record.size; len += bytes_read) {
+            if (f_read(&file, chunk, min<uint16_t>(sizeof(chunk), record.size - len), &bytes_read) != FR_OK
+                || bytes_read == 0)
+                break;
+            if (len + bytes_read == record.size)
+                yp.set_eof();
+            if (yp.parse(chunk, bytes_read) != YamlParser::CONTINUE_PARSING)
+                break;
+        }
+        f_lseek(&file, start + record.size);
+    }
+
+    f_close(&file);
+    return true;
+}
+
+struct yaml_journal_ctx {
+    uint32_t size;
+    uint16_t crc;
+};
+
+static bool yaml_journal_counter(void* opaque, const char* str, size_t len)
+{
+    yaml_journal_ctx* ctx = (yaml_journal_ctx*)opaque;
+    ctx->size += len;
+    ctx->crc = crc16(CRC_1021, (const uint8_t*)str, len, ctx->crc);
+    return true;
+}
+
+// Appends the modified nodes to the journal. Returns false if the model
+// has to be written in full instead
+static bool writeModelJournal(const char* path, const char** error)
+{
+    *error = nullptr;
+
+    if (!modelJournal.valid || strcmp(path, modelJournal.path))
+        return false;
+
+    const YamlNode* nodes = get_modeldata_nodes()->u._array.child;
+    uint8_t count = getModelNodesCount();
+
+    // the clean nodes are replaced with padding of the same size
+    uint64_t dirty = 0;
+    uint32_t hashes[MODEL_JOURNAL_MAX_NODES];
+    for (uint8_t i = 0; i < count; i++) {
+        hashes[i] = getNodeHash(i);
+        modelJournalNodes[i] = nodes[i];
+        if (nodes[i].type == YDT_PADDING)
+            continue;
+        if (hashes[i] != modelJournal.hashes[i]) {
+            dirty |= (uint64_t)1 << i;
+        }
+        else {
+            memclear(&modelJournalNodes[i], sizeof(YamlNode));
+            modelJournalNodes[i].type = YDT_PADDING;
+            modelJournalNodes[i].size = getNodeBits(&nodes[i]);
+        }
+    }
+    memclear(&modelJournalNodes[count], sizeof(YamlNode));
+
+    if (!dirty) {
+        TRACE("model journal: no change");
+        return true;
+    }
+
+    YamlNode root;
+    memclear(&root, sizeof(root));
+    root.type = YDT_ARRAY;
+    root.u._array.child = modelJournalNodes;
+    root.u._array.u._a.elmts = 1;
+
+    YamlTreeWalker tree;
+    tree.reset(&root, (uint8_t*)&g_model);
+
+    yaml_journal_ctx counter = { 0, 0 };
+    tree.generate(yaml_journal_counter, &counter);
+    uint32_t headerSize = (modelJournal.size == 0 ? sizeof(ModelJournalHeader) : 0);
+    if (counter.size == 0 || modelJournal.size + headerSize + sizeof(ModelJournalRecord) + counter.size > MODEL_JOURNAL_MAX_SIZE)
+        return false;
+
+    char journalPath[256];
+    getModelJournalPath(journalPath, path, MODEL_JOURNAL_EXT);
+
+    FIL file;
+    FRESULT result = f_open(&file, journalPath, FA_OPEN_ALWAYS | FA_WRITE);
+    if (result == FR_OK && f_size(&file) != modelJournal.size) {
+        // not the journal we know about
+        f_close(&file);
+        return false;
+    }
+    if (result == FR_OK)
+        result = f_lseek(&file, modelJournal.size);
+    if (result != FR_OK) {
+        f_close(&file);
+        *error = SDCARD_ERROR(result);
+        return true;
+    }
+
+    UINT bytes_written;
+    if (headerSize) {
+        ModelJournalHeader header;
+        header.magic = MODEL_JOURNAL_MAGIC;
+        header.baseHash = modelJournal.baseHash;
+        result = f_write(&file, &header, sizeof(header), &bytes_written);
+    }
+
+    ModelJournalRecord record;
+    record.nodes = dirty;
+    record.size = counter.size;
+    record.crc = counter.crc;
+
+    if (result == FR_OK)
+        result = f_write(&file, &record, sizeof(record), &bytes_written);
+
+    yaml_writer_ctx ctx;
+    ctx.file = &file;
+    ctx.result = result;
+    ctx.hash = YAML_HASH_INIT;
+    tree.reset(&root, (uint8_t*)&g_model);
+    if (result == FR_OK && !tree.generate(yaml_writer, &ctx))
+        result = ctx.result;
+
+    f_close(&file);
+
+    if (result != FR_OK) {
+        // the journal can't be trusted anymore
+        modelJournal.valid = false;
+        *error = SDCARD_ERROR(result);
+        return true;
+    }
+
+    TRACE("model journal: %d bytes appended", headerSize + sizeof(record) + counter.size);
+    modelJournal.size += headerSize + sizeof(record) + counter.size;
+    memcpy(modelJournal.hashes, hashes, count * sizeof(uint32_t));
+    return true;
+}
+
 const char * readModelYaml(const char * filename, uint8_t * buffer, uint32_t size)
 {
     // YAML reader
@@ -218,6 +586,17 @@ const char * readModelYaml(const char * filename, uint8_t * buffer, uint32_t siz
     char path[256];
     getModelPath(path, filename);
 
+    // power loss while the model file was replaced
+    FILINFO fno;
+    if (f_stat(path, &fno) != FR_OK) {
+        char tmpPath[256];
+        getModelJournalPath(tmpPath, path, MODEL_TMP_EXT);
+        if (f_stat(tmpPath, &fno) == FR_OK) {
+            TRACE("YAML model recovered from %s", tmpPath);
+            f_rename(tmpPath, path);
+        }
+    }
+
     YamlTreeWalker tree;
     tree.reset(data_nodes, buffer);
 
@@ -225,24 +604,31 @@ const char * readModelYaml(const char * filename, uint8_t * buffer, uint32_t siz
     memset(buffer,0,size);
 
     if (init_model) {
-      auto md = reinterpret_cast<ModelData*>(buffer);
-#if defined(FLIGHT_MODES) && defined(GVARS)
-      // reset GVars to default values
-      // Note: taken from opentx.cpp::modelDefault()
-      //TODO: new func in gvars
-      for (int p=1; p<MAX_FLIGHT_MODES; p++) {
-        for (int i=0; i<MAX_GVARS; i++) {
-          md->flightModeData[p].gvars[i] = GVAR_MAX+1;
-        }
-      }
-#endif
+      setModelGVarsDefaults(reinterpret_cast<ModelData*>(buffer));
       // is that necessary ???
       // md->swashR.collectiveWeight = 100;
       // md->swashR.aileronWeight    = 100;
       // md->swashR.elevatorWeight   = 100;
     }
 
-    return readYamlFile(path, YamlTreeWalker::get_parser_calls(), &tree);
+    uint32_t hash;
+    const char* error = readYamlFile(path, YamlTreeWalker::get_parser_calls(), &tree, &hash);
+    if (error)
+        return error;
+
+    bool journal = readModelJournal(path, hash, buffer, size);
+
+    if (buffer == (uint8_t*)&g_model) {
+        initModelJournal(path, hash);
+        // the journal may end with an incomplete record: it is not
+        // appended to, but merged by rewriting the whole model file
+        if (journal) {
+            modelJournal.valid = false;
+            storageDirty(EE_MODEL);
+        }
+    }
+
+    return nullptr;
 }
 
 static const char _wrongExtentionError[] = "wrong file extension";
@@ -257,12 +643,34 @@ const char* readModel(const char* filename, uint8_t* buffer, uint32_t size)
   return readModelYaml(filename, buffer, size);
 }
 
-const char * writeModelYaml(const char* filename)
+const char * writeModelYaml(const char* filename, bool compact)
 {
     TRACE("YAML model writer");
     char path[256];
     getModelPath(path, filename);
-    return writeFileYaml(path, get_modeldata_nodes(), (uint8_t*)&g_model);
+
+    const char* error;
+    if (!compact && writeModelJournal(path, &error))
+        return error;
+
+    char tmpPath[256];
+    getModelJournalPath(tmpPath, path, MODEL_TMP_EXT);
+    uint32_t hash;
+    error = writeFileYaml(tmpPath, get_modeldata_nodes(), (uint8_t*)&g_model, &hash);
+    if (error)
+        return error;
+
+    f_unlink(path);
+    FRESULT result = f_rename(tmpPath, path);
+    if (result != FR_OK)
+        return SDCARD_ERROR(result);
+
+    char journalPath[256];
+    getModelJournalPath(journalPath, path, MODEL_JOURNAL_EXT);
+    f_unlink(journalPath);
+
+    initModelJournal(path, hash);
+    return nullptr;
 }
 
 #if !defined(STORAGE_MODELSLIST)
@@ -278,15 +686,15 @@ void getModelNumberStr(uint8_t idx, char* model_idx)
 }
 #endif
 
-const char * writeModel()
+const char * writeModel(bool compact)
 {
 #if defined(STORAGE_MODELSLIST)
-  return writeModelYaml(g_eeGeneral.currModelFilename);
+  return writeModelYaml(g_eeGeneral.currModelFilename, compact);
 #else
   char fname[MODELIDX_STRLEN + sizeof(YAML_EXT)];
   getModelNumberStr(g_eeGeneral.currModel, fname);
   strcat(fname, YAML_EXT);
-  return writeModelYaml(fname);
+  return writeModelYaml(fname, compact);
 #endif
 }
 
@@ -23,6 +23,7 @@
 constexpr uint8_t MODELIDX_STRLEN = sizeof(MODEL_FILENAME_PREFIX "00");
 
 const char * loadRadioSettingsYaml();
-const char * writeModelYaml(const char* filename);
+const char * writeModelYaml(const char* filename, bool compact = true);
+bool isModelJournalPending();
 const char * readModelYaml(const char * filename, uint8_t * buffer, uint32_t size);
 void getModelNumberStr(uint8_t idx, char* model_idx);
@@ -73,6 +73,11 @@ void preModelLoad()
 #if defined(COLORLCD)
   deleteCustomScreens();
 #endif
+
+#if defined(DISK_CACHE)
+  // the previous model has been saved
+  diskCache.flush();
+#endif
 }
 
 void postRadioSettingsLoad()
@@ -171,6 +176,13 @@ void postModelLoad(bool alarms)
 #endif
 #endif
 
+#if defined(GVARS)
+  clearGVarRuntimeValues();
+#endif
+#if defined(OVERRIDE_CHANNEL_FUNCTION)
+  clearChannelRuntimeValues();
+#endif
+
   AUDIO_FLUSH();
   flightReset(false);
 
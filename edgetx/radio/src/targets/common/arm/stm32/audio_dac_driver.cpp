@@ -181,6 +181,7 @@ void audioEnd()
 extern "C" void AUDIO_TIM_IRQHandler()
 {
   DEBUG_INTERRUPT(INT_AUDIO);
+  EVENT_TRACE_ISR(EVENT_TRACE_ISR_AUDIO);
   DAC->CR &= ~DAC_CR_DMAEN1 ;     // Stop DMA requests
 #if defined(STM32F2)
   DAC->CR &= ~DAC_CR_DMAUDRIE1 ;  // Stop underrun interrupt
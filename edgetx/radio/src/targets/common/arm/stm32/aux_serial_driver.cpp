@@ -24,7 +24,7 @@
 
 #if defined(AUX_SERIAL)
 uint8_t auxSerialMode = UART_MODE_COUNT;  // Prevent debug output before port is setup
-Fifo<uint8_t, 512> auxSerialTxFifo;
+AuxSerialTxFifo auxSerialTxFifo;
 
 #if defined(AUX_SERIAL_DMA_Stream_RX)
 AuxSerialRxFifo auxSerialRxFifo __DMA (AUX_SERIAL_DMA_Stream_RX);
@@ -192,6 +192,7 @@ uint8_t auxSerialTracesEnabled()
 extern "C" void AUX_SERIAL_USART_IRQHandler(void)
 {
   DEBUG_INTERRUPT(INT_SER2);
+  EVENT_TRACE_ISR(EVENT_TRACE_ISR_AUX_SERIAL);
 
   // Send
   if (USART_GetITStatus(AUX_SERIAL_USART, USART_IT_TXE) != RESET) {
@@ -241,7 +242,7 @@ extern "C" void AUX_SERIAL_USART_IRQHandler(void)
 
 #if defined(AUX2_SERIAL)
 uint8_t aux2SerialMode = UART_MODE_COUNT;  // Prevent debug output before port is setup
-Fifo<uint8_t, 512> aux2SerialTxFifo;
+AuxSerialTxFifo aux2SerialTxFifo;
 AuxSerialRxFifo aux2SerialRxFifo __DMA (AUX2_SERIAL_DMA_Stream_RX);
 
 void aux2SerialSetup(unsigned int baudrate, bool dma, uint16_t length, uint16_t parity, uint16_t stop)
@@ -384,6 +385,7 @@ uint8_t aux2SerialTracesEnabled()
 extern "C" void AUX2_SERIAL_USART_IRQHandler(void)
 {
   DEBUG_INTERRUPT(INT_SER2);
+  EVENT_TRACE_ISR(EVENT_TRACE_ISR_AUX_SERIAL);
 
   // Send
   if (USART_GetITStatus(AUX2_SERIAL_USART, USART_IT_TXE) != RESET) {
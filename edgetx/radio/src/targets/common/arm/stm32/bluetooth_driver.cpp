@@ -23,7 +23,16 @@
 
 #if !defined(BOOT)
 Fifo<uint8_t, BT_TX_FIFO_SIZE> btTxFifo;
-Fifo<uint8_t, BT_RX_FIFO_SIZE> btRxFifo;
+#if defined(BT_DMA_Stream_RX)
+BluetoothRxFifo btRxFifo __DMA (BT_DMA_Stream_RX);
+#else
+BluetoothRxFifo btRxFifo;
+#endif
+
+#if defined(BT_DMA_Stream_TX)
+// the TX fifo is copied in chunks to this buffer, the DMA reads from there
+static uint8_t btTxDmaBuffer[BT_TX_FIFO_SIZE] __DMA;
+#endif
 
 #if defined(BLUETOOTH_PROBE)
 volatile uint8_t btChipPresent = 0;
@@ -86,15 +95,51 @@ void bluetoothInit(uint32_t baudrate, bool enable)
   USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
   USART_InitStructure.USART_Mode = USART_Mode_Tx | USART_Mode_Rx;
   USART_Init(BT_USART, &USART_InitStructure);
+
+#if defined(BT_DMA_Stream_RX)
+  DMA_Cmd(BT_DMA_Stream_RX, DISABLE);
+  USART_DMACmd(BT_USART, USART_DMAReq_Rx, DISABLE);
+  DMA_DeInit(BT_DMA_Stream_RX);
+  btRxFifo.clear();
+
+  DMA_InitTypeDef DMA_InitStructure;
+  DMA_InitStructure.DMA_Channel = BT_DMA_Channel_RX;
+  DMA_InitStructure.DMA_PeripheralBaseAddr = CONVERT_PTR_UINT(&BT_USART->DR);
+  DMA_InitStructure.DMA_Memory0BaseAddr = CONVERT_PTR_UINT(btRxFifo.buffer());
+  DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralToMemory;
+  DMA_InitStructure.DMA_BufferSize = btRxFifo.size();
+  DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+  DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+  DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+  DMA_InitStructure.DMA_Mode = DMA_Mode_Circular;
+  DMA_InitStructure.DMA_Priority = DMA_Priority_Low;
+  DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
+  DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_Full;
+  DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
+  DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
+  DMA_Init(BT_DMA_Stream_RX, &DMA_InitStructure);
+  USART_DMACmd(BT_USART, USART_DMAReq_Rx, ENABLE);
+  USART_Cmd(BT_USART, ENABLE);
+  DMA_Cmd(BT_DMA_Stream_RX, ENABLE);
+#else
   USART_Cmd(BT_USART, ENABLE);
 
   USART_ITConfig(BT_USART, USART_IT_RXNE, ENABLE);
+  btRxFifo.clear();
+#endif
   NVIC_SetPriority(BT_USART_IRQn, 6);
   NVIC_EnableIRQ(BT_USART_IRQn);
 
+#if defined(BT_DMA_Stream_TX)
+  DMA_Cmd(BT_DMA_Stream_TX, DISABLE);
+  DMA_DeInit(BT_DMA_Stream_TX);
+  NVIC_SetPriority(BT_DMA_TX_Stream_IRQn, 6);
+  NVIC_EnableIRQ(BT_DMA_TX_Stream_IRQn);
+#endif
+
   bluetoothWriteState = BLUETOOTH_WRITE_IDLE;
 
-  btRxFifo.clear();
   btTxFifo.clear();
 #endif
 
@@ -109,6 +154,14 @@ void bluetoothDisable()
 {
   GPIO_SetBits(BT_EN_GPIO, BT_EN_GPIO_PIN); // close bluetooth (recent modules will go to bootloader mode)
   USART_ITConfig(BT_USART, USART_IT_RXNE, DISABLE);
+#if defined(BT_DMA_Stream_RX)
+  DMA_Cmd(BT_DMA_Stream_RX, DISABLE);
+  USART_DMACmd(BT_USART, USART_DMAReq_Rx, DISABLE);
+#endif
+#if defined(BT_DMA_Stream_TX)
+  DMA_Cmd(BT_DMA_Stream_TX, DISABLE);
+  USART_DMACmd(BT_USART, USART_DMAReq_Tx, DISABLE);
+#endif
   GPIO_InitTypeDef GPIO_InitStructure;
   GPIO_InitStructure.GPIO_Pin = BT_RX_GPIO_PIN;
   GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IN;
@@ -121,9 +174,12 @@ extern "C" void BT_USART_IRQHandler(void)
   DEBUG_INTERRUPT(INT_BLUETOOTH);
   if (USART_GetITStatus(BT_USART, USART_IT_RXNE) != RESET) {
     USART_ClearITPendingBit(BT_USART, USART_IT_RXNE);
+#if !defined(BT_DMA_Stream_RX)
+    // with DMA, the received bytes are already in the FIFO
     uint8_t byte = USART_ReceiveData(BT_USART);
     btRxFifo.push(byte);
     BLUETOOTH_TRACE_VERBOSE("BT %02X" CRLF, byte);
+#endif
 #if defined(BLUETOOTH_PROBE)
     if (!btChipPresent) {
       // This is to differentiate X7 and X7S and X-Lite with/without BT
@@ -146,6 +202,61 @@ extern "C" void BT_USART_IRQHandler(void)
   }
 }
 
+#if defined(BT_DMA_Stream_TX)
+// returns false when there was nothing left to send
+static bool bluetoothSendNextChunk()
+{
+  uint32_t count = btTxFifo.pop(btTxDmaBuffer, sizeof(btTxDmaBuffer));
+  if (count == 0)
+    return false;
+
+  DMA_InitTypeDef DMA_InitStructure;
+  DMA_DeInit(BT_DMA_Stream_TX);
+  DMA_InitStructure.DMA_Channel = BT_DMA_Channel_TX;
+  DMA_InitStructure.DMA_PeripheralBaseAddr = CONVERT_PTR_UINT(&BT_USART->DR);
+  DMA_InitStructure.DMA_DIR = DMA_DIR_MemoryToPeripheral;
+  DMA_InitStructure.DMA_Memory0BaseAddr = CONVERT_PTR_UINT(btTxDmaBuffer);
+  DMA_InitStructure.DMA_BufferSize = count;
+  DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+  DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+  DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+  DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+  DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+  DMA_InitStructure.DMA_Priority = DMA_Priority_Low;
+  DMA_InitStructure.DMA_FIFOMode = DMA_FIFOMode_Disable;
+  DMA_InitStructure.DMA_FIFOThreshold = DMA_FIFOThreshold_Full;
+  DMA_InitStructure.DMA_MemoryBurst = DMA_MemoryBurst_Single;
+  DMA_InitStructure.DMA_PeripheralBurst = DMA_PeripheralBurst_Single;
+  DMA_Init(BT_DMA_Stream_TX, &DMA_InitStructure);
+  DMA_ITConfig(BT_DMA_Stream_TX, DMA_IT_TC, ENABLE);
+  DMA_Cmd(BT_DMA_Stream_TX, ENABLE);
+  USART_DMACmd(BT_USART, USART_DMAReq_Tx, ENABLE);
+  return true;
+}
+
+extern "C" void BT_DMA_TX_IRQHandler(void)
+{
+  if (DMA_GetITStatus(BT_DMA_Stream_TX, BT_DMA_TX_FLAG_TC)) {
+    DMA_ClearITPendingBit(BT_DMA_Stream_TX, BT_DMA_TX_FLAG_TC);
+    if (!bluetoothSendNextChunk()) {
+      USART_DMACmd(BT_USART, USART_DMAReq_Tx, DISABLE);
+      bluetoothWriteState = BLUETOOTH_WRITE_DONE;
+    }
+  }
+}
+#endif
+
+static void bluetoothStartWriting()
+{
+  bluetoothWriteState = BLUETOOTH_WRITING;
+#if defined(BT_DMA_Stream_TX)
+  if (!bluetoothSendNextChunk())
+    bluetoothWriteState = BLUETOOTH_WRITE_DONE;
+#else
+  USART_ITConfig(BT_USART, USART_IT_TXE, ENABLE);
+#endif
+}
+
 void bluetoothWriteWakeup()
 {
   if (bluetoothWriteState == BLUETOOTH_WRITE_IDLE) {
@@ -154,15 +265,13 @@ void bluetoothWriteWakeup()
       bluetoothWriteState = BLUETOOTH_WRITE_INIT;
       GPIO_ResetBits(BT_BRTS_GPIO, BT_BRTS_GPIO_PIN);
 #else
-      bluetoothWriteState = BLUETOOTH_WRITING;
-      USART_ITConfig(BT_USART, USART_IT_TXE, ENABLE);
+      bluetoothStartWriting();
 #endif
     }
   }
 #if defined(BT_BRTS_GPIO_PIN)
   else if (bluetoothWriteState == BLUETOOTH_WRITE_INIT) {
-    bluetoothWriteState = BLUETOOTH_WRITING;
-    USART_ITConfig(BT_USART, USART_IT_TXE, ENABLE);
+    bluetoothStartWriting();
   }
   else if (bluetoothWriteState == BLUETOOTH_WRITE_DONE) {
     bluetoothWriteState = BLUETOOTH_WRITE_IDLE;
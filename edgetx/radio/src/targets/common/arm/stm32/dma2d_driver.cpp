@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include "opentx.h"
+
+// DMA2D transfers
+//
+// Each DMA*() call is turned into a register snapshot (Dma2dCommand), which
+// is started and polled until completion: libopenui draws with the CPU on
+// the same buffers between the DMA2D calls.
+
+#define DMA2D_FLAGS                    (DMA2D_IFSR_CTCIF | DMA2D_IFSR_CTEIF | DMA2D_IFSR_CCEIF)
+
+struct Dma2dCommand
+{
+  uint32_t mode;
+  uint32_t opfccr;
+  uint32_t ocolr;
+  uint32_t omar;
+  uint32_t oor;
+  uint32_t nlr;
+  uint32_t fgmar;
+  uint32_t fgor;
+  uint32_t fgpfccr;
+  uint32_t fgcolr;
+  uint32_t bgmar;
+  uint32_t bgor;
+  uint32_t bgpfccr;
+};
+
+static void dma2dStart(const Dma2dCommand & cmd)
+{
+  DMA2D->OPFCCR = cmd.opfccr;
+  DMA2D->OCOLR = cmd.ocolr;
+  DMA2D->OMAR = cmd.omar;
+  DMA2D->OOR = cmd.oor;
+  DMA2D->NLR = cmd.nlr;
+  DMA2D->FGMAR = cmd.fgmar;
+  DMA2D->FGOR = cmd.fgor;
+  DMA2D->FGPFCCR = cmd.fgpfccr;
+  DMA2D->FGCOLR = cmd.fgcolr;
+  DMA2D->BGMAR = cmd.bgmar;
+  DMA2D->BGOR = cmd.bgor;
+  DMA2D->BGPFCCR = cmd.bgpfccr;
+
+  DMA2D->IFCR = DMA2D_FLAGS;
+  DMA2D->CR = cmd.mode | DMA2D_CR_START;
+}
+
+static void dma2dSubmit(const Dma2dCommand & cmd)
+{
+  dma2dStart(cmd);
+  while (DMA2D->CR & DMA2D_CR_START);
+}
+
+void DMAInit()
+{
+  DMA2D_DeInit();
+  DMA2D->IFCR = DMA2D_FLAGS;
+}
+
+void DMAFillRect(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+#if defined(LCD_VERTICAL_INVERT)
+  x = destw - (x + w);
+  y = desth - (y + h);
+#endif
+
+  Dma2dCommand cmd = {};
+  cmd.mode = DMA2D_R2M;
+  cmd.opfccr = DMA2D_RGB565;
+  cmd.ocolr = color;
+  cmd.omar = CONVERT_PTR_UINT(dest + y*destw + x);
+  cmd.oor = destw - w;
+  cmd.nlr = (w << 16) | h;
+  dma2dSubmit(cmd);
+}
+
+void DMACopyBitmap(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, const uint16_t * src, uint16_t srcw, uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w, uint16_t h)
+{
+#if defined(LCD_VERTICAL_INVERT)
+  x = destw - (x + w);
+  y = desth - (y + h);
+  srcx = srcw - (srcx + w);
+  srcy = srch - (srcy + h);
+#endif
+
+  Dma2dCommand cmd = {};
+  cmd.mode = DMA2D_M2M;
+  cmd.opfccr = DMA2D_RGB565;
+  cmd.omar = CONVERT_PTR_UINT(dest + y*destw + x);
+  cmd.oor = destw - w;
+  cmd.nlr = (w << 16) | h;
+  cmd.fgmar = CONVERT_PTR_UINT(src + srcy*srcw + srcx);
+  cmd.fgor = srcw - w;
+  cmd.fgpfccr = CM_RGB565;
+  dma2dSubmit(cmd);
+}
+
+void DMACopyAlphaBitmap(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, const uint16_t * src, uint16_t srcw, uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w, uint16_t h)
+{
+#if defined(LCD_VERTICAL_INVERT)
+  x = destw - (x + w);
+  y = desth - (y + h);
+  srcx = srcw - (srcx + w);
+  srcy = srch - (srcy + h);
+#endif
+
+  Dma2dCommand cmd = {};
+  cmd.mode = DMA2D_M2M_BLEND;
+  cmd.opfccr = DMA2D_RGB565;
+  cmd.omar = CONVERT_PTR_UINT(dest + y*destw + x);
+  cmd.oor = destw - w;
+  cmd.nlr = (w << 16) | h;
+  cmd.fgmar = CONVERT_PTR_UINT(src + srcy*srcw + srcx);
+  cmd.fgor = srcw - w;
+  cmd.fgpfccr = CM_ARGB4444;
+  cmd.bgmar = CONVERT_PTR_UINT(dest + y*destw + x);
+  cmd.bgor = destw - w;
+  cmd.bgpfccr = CM_RGB565;
+  dma2dSubmit(cmd);
+}
+
+// same as DMACopyAlphaBitmap(), but with an 8 bit mask for each pixel (used by fonts)
+void DMACopyAlphaMask(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, const uint8_t * src, uint16_t srcw, uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w, uint16_t h, uint16_t bg_color)
+{
+#if defined(LCD_VERTICAL_INVERT)
+  x = destw - (x + w);
+  y = desth - (y + h);
+  srcx = srcw - (srcx + w);
+  srcy = srch - (srcy + h);
+#endif
+
+  Dma2dCommand cmd = {};
+  cmd.mode = DMA2D_M2M_BLEND;
+  cmd.opfccr = DMA2D_RGB565;
+  cmd.omar = CONVERT_PTR_UINT(dest + y*destw + x);
+  cmd.oor = destw - w;
+  cmd.nlr = (w << 16) | h;
+  cmd.fgmar = CONVERT_PTR_UINT(src + srcy*srcw + srcx);
+  cmd.fgor = srcw - w;
+  cmd.fgpfccr = CM_A8; // 8 bit inputs every time
+  cmd.fgcolr = (GET_RED(bg_color) << 16) | (GET_GREEN(bg_color) << 8) | GET_BLUE(bg_color);
+  cmd.bgmar = CONVERT_PTR_UINT(dest + y*destw + x);
+  cmd.bgor = destw - w;
+  cmd.bgpfccr = CM_RGB565;
+  dma2dSubmit(cmd);
+}
+
+void DMABitmapConvert(uint16_t * dest, const uint8_t * src, uint16_t w, uint16_t h, uint32_t format)
+{
+  Dma2dCommand cmd = {};
+  cmd.mode = DMA2D_M2M_PFC;
+  cmd.opfccr = format;
+  cmd.omar = CONVERT_PTR_UINT(dest);
+  cmd.nlr = (w << 16) | h;
+  cmd.fgmar = CONVERT_PTR_UINT(src);
+  cmd.fgpfccr = CM_ARGB8888 | (REPLACE_ALPHA_VALUE << 16);
+  dma2dSubmit(cmd);
+}
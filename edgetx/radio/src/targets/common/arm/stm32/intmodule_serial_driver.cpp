@@ -151,6 +151,7 @@ void intmoduleSerialStart(const etx_serial_init* params)
 #define USART_FLAG_ERRORS (USART_FLAG_ORE | USART_FLAG_NE | USART_FLAG_FE | USART_FLAG_PE)
 extern "C" void INTMODULE_USART_IRQHandler(void)
 {
+  EVENT_TRACE_ISR(EVENT_TRACE_ISR_INTMODULE);
 #if !defined(INTMODULE_DMA_STREAM)
   // Send
   if (USART_GetITStatus(INTMODULE_USART, USART_IT_TXE) != RESET) {
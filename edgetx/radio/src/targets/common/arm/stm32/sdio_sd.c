@@ -20,6 +20,7 @@
 
 #include "sdio_sd.h"
 #include "debug.h"
+#include "event_trace.h"
 
 #define SDIO_STATIC_FLAGS               ((uint32_t)0x000005FF)
 #define SDIO_CMD0TIMEOUT                ((uint32_t)0x00010000)
@@ -2012,13 +2013,17 @@ OPTIMIZE("O0") static SD_Error FindSCR(uint16_t rca, uint32_t *pscr)
 void SDIO_IRQHandler(void)
 {
   DEBUG_INTERRUPT(INT_SDIO);
+  EVENT_TRACE_ISR_ENTER(EVENT_TRACE_ISR_SDIO);
   SD_ProcessIRQ();
+  EVENT_TRACE_ISR_EXIT(EVENT_TRACE_ISR_SDIO);
 }
 
 void SD_SDIO_DMA_IRQHANDLER(void)
 {
   DEBUG_INTERRUPT(INT_SDIO_DMA);
+  EVENT_TRACE_ISR_ENTER(EVENT_TRACE_ISR_SDIO);
   SD_ProcessDMAIRQ();
+  EVENT_TRACE_ISR_EXIT(EVENT_TRACE_ISR_SDIO);
 }
 
 /************************ (C) COPYRIGHT STMicroelectronics *****END OF FILE****/
@@ -56,9 +56,14 @@ int usbPlugged()
 
 USB_OTG_CORE_HANDLE USB_OTG_dev;
 
+#if !defined(BOOT)
+static void usbJoystickStart();
+#endif
+
 extern "C" void OTG_FS_IRQHandler()
 {
   DEBUG_INTERRUPT(INT_OTG_FS);
+  EVENT_TRACE_ISR(EVENT_TRACE_ISR_USB);
   USBD_OTG_ISR_Handler(&USB_OTG_dev);
 }
 
@@ -75,6 +80,7 @@ void usbStart()
 #if !defined(BOOT)
     case USB_JOYSTICK_MODE:
       // initialize USB as HID device
+      usbJoystickStart();
       USBD_Init(&USB_OTG_dev, USB_OTG_FS_CORE_ID, &USR_desc, &USBD_HID_cb, &USR_cb);
       break;
 #endif
@@ -105,47 +111,154 @@ bool usbStarted()
 }
 
 #if !defined(BOOT)
-/*
-  Prepare and send new USB data packet
+static_assert(USB_JOYSTICK_AXES >= 1 && USB_JOYSTICK_AXES <= USB_JOYSTICK_MAX_AXES, "Wrong USB joystick axes count");
+static_assert(USB_JOYSTICK_BUTTONS <= USB_JOYSTICK_MAX_BUTTONS, "Wrong USB joystick buttons count");
+static_assert(USB_JOYSTICK_BUTTONS_SOURCE == USB_JOYSTICK_BUTTONS_LOGICAL_SWITCHES ?
+              USB_JOYSTICK_BUTTONS <= MAX_LOGICAL_SWITCHES :
+              USB_JOYSTICK_AXES + USB_JOYSTICK_BUTTONS <= MAX_OUTPUT_CHANNELS, "Not enough USB joystick buttons sources");
 
-  The format of HID_Buffer is defined by
-  USB endpoint description can be found in
-  file usb_hid_joystick.c, variable HID_JOYSTICK_ReportDesc
-*/
-void usbJoystickUpdate()
+// The mixer task builds the reports alternately in one of the two buffers,
+// the SOF interrupt sends the last complete one once (copied to the TX
+// buffer, which must stay untouched until the transfer completes).
+static uint8_t usbJoystickReports[2][HID_IN_PACKET_MAX];
+static uint8_t usbJoystickTxBuffer[HID_IN_PACKET_MAX];
+static volatile uint8_t usbJoystickLastReport;
+static volatile bool usbJoystickReportPending;
+static uint16_t usbJoystickReportSize;
+
+static const uint8_t usbJoystickAxisUsages[USB_JOYSTICK_MAX_AXES] = {
+  0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x36, // X, Y, Z, Rx, Ry, Rz, Slider, Slider
+  0x37, 0x38, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, // Dial, Wheel, Vx, Vy, Vz, Vbrx, Vbry, Vbrz
+};
+
+static uint8_t * hidItem(uint8_t * p, uint8_t tag, uint8_t value)
+{
+  *p++ = tag | 0x01;
+  *p++ = value;
+  return p;
+}
+
+static uint8_t * hidItem16(uint8_t * p, uint8_t tag, int16_t value)
 {
-  static uint8_t HID_Buffer[HID_IN_PACKET];
-
-  // test to se if TX buffer is free
-  if (USBD_HID_SendReport(&USB_OTG_dev, 0, 0) == USBD_OK) {
-    //buttons
-    HID_Buffer[0] = 0;
-    HID_Buffer[1] = 0;
-    HID_Buffer[2] = 0;
-    for (int i = 0; i < 8; ++i) {
-      if ( channelOutputs[i+8] > 0 ) {
-        HID_Buffer[0] |= (1 << i);
-      }
-      if ( channelOutputs[i+16] > 0 ) {
-        HID_Buffer[1] |= (1 << i);
-      }
-      if ( channelOutputs[i+24] > 0 ) {
-        HID_Buffer[2] |= (1 << i);
-      }
+  *p++ = tag | 0x02;
+  *p++ = value & 0xFF;
+  *p++ = (value >> 8) & 0xFF;
+  return p;
+}
+
+// Returns the descriptor size, the report size is stored in usbJoystickReportSize
+static uint16_t usbJoystickBuildReportDesc(uint8_t * desc)
+{
+  uint8_t * p = desc;
+
+  p = hidItem(p, 0x04, 0x01);                   // USAGE_PAGE (Generic Desktop)
+  p = hidItem(p, 0x08, 0x05);                   // USAGE (Game Pad)
+  p = hidItem(p, 0xA0, 0x01);                   // COLLECTION (Application)
+  p = hidItem(p, 0xA0, 0x00);                   //   COLLECTION (Physical)
+
+  uint16_t size = 0;
+
+  if (USB_JOYSTICK_BUTTONS > 0) {
+    p = hidItem(p, 0x04, 0x09);                 //     USAGE_PAGE (Button)
+    p = hidItem(p, 0x18, 0x01);                 //     USAGE_MINIMUM (Button 1)
+    p = hidItem(p, 0x28, USB_JOYSTICK_BUTTONS); //     USAGE_MAXIMUM (Button n)
+    p = hidItem(p, 0x14, 0x00);                 //     LOGICAL_MINIMUM (0)
+    p = hidItem(p, 0x24, 0x01);                 //     LOGICAL_MAXIMUM (1)
+    p = hidItem(p, 0x94, USB_JOYSTICK_BUTTONS); //     REPORT_COUNT (n)
+    p = hidItem(p, 0x74, 0x01);                 //     REPORT_SIZE (1)
+    p = hidItem(p, 0x80, 0x02);                 //     INPUT (Data,Var,Abs)
+    uint8_t padding = (8 - (USB_JOYSTICK_BUTTONS & 0x07)) & 0x07;
+    if (padding) {
+      p = hidItem(p, 0x94, padding);            //     REPORT_COUNT (padding)
+      p = hidItem(p, 0x80, 0x01);               //     INPUT (Cnst,Ary,Abs)
     }
+    size += (USB_JOYSTICK_BUTTONS + 7) / 8;
+  }
+
+  p = hidItem(p, 0x04, 0x01);                   //     USAGE_PAGE (Generic Desktop)
+  for (uint8_t i = 0; i < USB_JOYSTICK_AXES; i++) {
+    p = hidItem(p, 0x08, usbJoystickAxisUsages[i]); //   USAGE (axis)
+  }
+  if (USB_JOYSTICK_RESOLUTION == USB_JOYSTICK_RES_16BIT) {
+    p = hidItem16(p, 0x14, -32767);             //     LOGICAL_MINIMUM (-32767)
+    p = hidItem16(p, 0x24, 32767);              //     LOGICAL_MAXIMUM (32767)
+  }
+  else {
+    p = hidItem16(p, 0x14, 0);                  //     LOGICAL_MINIMUM (0)
+    p = hidItem16(p, 0x24, 2047);               //     LOGICAL_MAXIMUM (2047)
+  }
+  p = hidItem(p, 0x74, 0x10);                   //     REPORT_SIZE (16)
+  p = hidItem(p, 0x94, USB_JOYSTICK_AXES);   //     REPORT_COUNT (n)
+  p = hidItem(p, 0x80, 0x02);                   //     INPUT (Data,Var,Abs)
+  size += 2 * USB_JOYSTICK_AXES;
 
-    //analog values
-    //uint8_t * p = HID_Buffer + 1;
-    for (int i = 0; i < 8; ++i) {
+  *p++ = 0xC0;                                  //   END_COLLECTION
+  *p++ = 0xC0;                                  // END_COLLECTION
 
-      int16_t value = channelOutputs[i] + 1024;
-      if ( value > 2047 ) value = 2047;
-      else if ( value < 0 ) value = 0;
-      HID_Buffer[i*2 +3] = static_cast<uint8_t>(value & 0xFF);
-      HID_Buffer[i*2 +4] = static_cast<uint8_t>((value >> 8) & 0x07);
+  usbJoystickReportSize = size;
+  return p - desc;
+}
+
+static void usbJoystickBuildReport(uint8_t * report)
+{
+  uint8_t * p = report;
 
+  if (USB_JOYSTICK_BUTTONS > 0) {
+    memset(p, 0, (USB_JOYSTICK_BUTTONS + 7) / 8);
+    for (uint8_t i = 0; i < USB_JOYSTICK_BUTTONS; i++) {
+      bool on;
+      if (USB_JOYSTICK_BUTTONS_SOURCE == USB_JOYSTICK_BUTTONS_LOGICAL_SWITCHES)
+        on = getSwitch(SWSRC_FIRST_LOGICAL_SWITCH + i);
+      else
+        on = channelOutputs[USB_JOYSTICK_AXES + i] > 0;
+      if (on)
+        p[i / 8] |= (1 << (i % 8));
     }
-    USBD_HID_SendReport(&USB_OTG_dev, HID_Buffer, HID_IN_PACKET);
+    p += (USB_JOYSTICK_BUTTONS + 7) / 8;
+  }
+
+  for (uint8_t i = 0; i < USB_JOYSTICK_AXES; i++) {
+    int32_t value;
+    if (USB_JOYSTICK_RESOLUTION == USB_JOYSTICK_RES_16BIT)
+      value = limit<int32_t>(-32767, channelOutputs[i] * 32, 32767);
+    else
+      value = limit<int32_t>(0, channelOutputs[i] + 1024, 2047);
+    *p++ = value & 0xFF;
+    *p++ = (value >> 8) & 0xFF;
+  }
+}
+
+// Called from the USB interrupt on each frame (1ms)
+static void usbJoystickSendReport()
+{
+  if (usbJoystickReportPending && USBD_HID_SendReport(&USB_OTG_dev, nullptr, 0) == USBD_OK) {
+    memcpy(usbJoystickTxBuffer, usbJoystickReports[usbJoystickLastReport], usbJoystickReportSize);
+    usbJoystickReportPending = false;
+    USBD_HID_SendReport(&USB_OTG_dev, usbJoystickTxBuffer, usbJoystickReportSize);
   }
 }
+
+static void usbJoystickStart()
+{
+  uint8_t desc[HID_REPORT_DESC_MAX_SIZE];
+  uint16_t len = usbJoystickBuildReportDesc(desc);
+  usbJoystickLastReport = 0;
+  usbJoystickReportPending = false;
+  USBD_HID_SetReportDesc(desc, len, usbJoystickReportSize);
+  USBD_HID_SetSOFCallback(usbJoystickSendReport);
+}
+
+/*
+  Prepare a new report from the mixer outputs, it will be sent on the
+  next USB frame
+*/
+void usbJoystickUpdate()
+{
+  uint8_t index = (usbJoystickLastReport == 0) ? 1 : 0;
+  usbJoystickBuildReport(usbJoystickReports[index]);
+  // the report must be complete before the interrupt may pick it
+  __DMB();
+  usbJoystickLastReport = index;
+  usbJoystickReportPending = true;
+}
 #endif
@@ -22,6 +22,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 // USB driver
@@ -46,8 +47,51 @@ bool usbStarted();
 int  getSelectedUsbMode();
 void setSelectedUsbMode(int mode);
 
+// USB joystick (HID) report layout
+//
+// Axis N is mapped to channel N. Buttons are either mapped to the channels
+// following the axes (on if > 0), or to the logical switches. The layout
+// is set by the USB_JOYSTICK_* build options, the default is the historical
+// one: 8 axes with 11 bit resolution, 24 buttons on channels 9-32. A report
+// is sent on the first USB frame after each mixer run.
+#define USB_JOYSTICK_MAX_AXES        16
+#define USB_JOYSTICK_MAX_BUTTONS     64
+
+enum UsbJoystickResolution {
+  USB_JOYSTICK_RES_11BIT,  // 0..2047
+  USB_JOYSTICK_RES_16BIT,  // -32767..32767
+};
+
+enum UsbJoystickButtons {
+  USB_JOYSTICK_BUTTONS_CHANNELS,
+  USB_JOYSTICK_BUTTONS_LOGICAL_SWITCHES,
+};
+
+#if !defined(USB_JOYSTICK_AXES)
+  #define USB_JOYSTICK_AXES          8
+#endif
+
+#if !defined(USB_JOYSTICK_RESOLUTION)
+  #define USB_JOYSTICK_RESOLUTION    USB_JOYSTICK_RES_11BIT
+#endif
+
+#if !defined(USB_JOYSTICK_BUTTONS)
+  #define USB_JOYSTICK_BUTTONS       24
+#endif
+
+#if !defined(USB_JOYSTICK_BUTTONS_SOURCE)
+  #define USB_JOYSTICK_BUTTONS_SOURCE  USB_JOYSTICK_BUTTONS_CHANNELS
+#endif
+
 uint32_t usbSerialFreeSpace();
-void     usbSerialPutc(uint8_t c);
+// returns the number of bytes accepted, limited by the free space
+size_t   usbSerialWrite(const uint8_t * buf, size_t len);
+
+#define USB_SERIAL_RX_FIFO_SIZE  1024
+
+// only used when no receive callback is set (i.e. without CLI)
+size_t   usbSerialRead(uint8_t * buf, size_t len);
+size_t   usbSerialRxAvailable();
 
 uint32_t usbSerialBaudRate(void);
 
@@ -23,8 +23,11 @@
 #pragma     data_alignment = 4
 #endif /* USB_OTG_HS_INTERNAL_DMA_ENABLED */
 
+#include <string.h>
+
 // include STM32 headers and generic board defs
 #include "board_common.h"
+#include "fifo.h"
 
 extern "C" {
 
@@ -82,6 +85,14 @@ static void (*baudRateCb)(uint32_t baud);
 
 bool cdcConnected = false;
 
+extern USB_OTG_CORE_HANDLE USB_OTG_dev;
+
+// Data received from the host when no receive callback is set, read with
+// usbSerialRead(). The OUT endpoint is NAKed while there is no room for a
+// whole packet, so that the host is slowed down instead of losing data.
+static Fifo<uint8_t, USB_SERIAL_RX_FIFO_SIZE> usbSerialRxFifo;
+static volatile bool usbSerialRxPaused = false;
+
 /* Private functions ---------------------------------------------------------*/
 /**
   * @brief  VCP_Init
@@ -91,6 +102,8 @@ bool cdcConnected = false;
   */
 static uint16_t VCP_Init(void)
 {
+  usbSerialRxFifo.clear();
+  usbSerialRxPaused = false;
   cdcConnected = true;
   ctrlLineStateCb = NULL;
   baudRateCb = NULL;
@@ -205,7 +218,7 @@ uint32_t usbSerialFreeSpace()
          1;
 }
 
-void usbSerialPutc(uint8_t c)
+size_t usbSerialWrite(const uint8_t * buf, size_t len)
 {
   /*
     Apparently there is no reliable way to tell if the
@@ -215,11 +228,12 @@ void usbSerialPutc(uint8_t c)
     of the physical USB connection.
   */
 
-  if (!cdcConnected) return;
+  if (!cdcConnected) return 0;
 
   /*
     APP_Rx_Buffer and associated variables must be modified
     atomically, because they are used from the interrupt
+    and written by several tasks
   */
 
   /* Read PRIMASK register, check interrupt status before you disable them */
@@ -228,10 +242,23 @@ void usbSerialPutc(uint8_t c)
   uint32_t prim = __get_PRIMASK();
   __disable_irq();
 
-  APP_Rx_Buffer[APP_Rx_ptr_in] = c;
-  APP_Rx_ptr_in = (APP_Rx_ptr_in + 1) % APP_RX_DATA_SIZE;
+  uint32_t in = APP_Rx_ptr_in;
+  uint32_t free = usbSerialFreeSpace();
+  if (len > free) len = free;
+
+  // at most 2 contiguous regions, before and after the wrap around
+  uint32_t first = APP_RX_DATA_SIZE - in;
+  if (first > len) first = len;
+  memcpy(&APP_Rx_Buffer[in], buf, first);
+  memcpy(&APP_Rx_Buffer[0], buf + first, len - first);
+
+  in += len;
+  if (in >= APP_RX_DATA_SIZE) in -= APP_RX_DATA_SIZE;
+  APP_Rx_ptr_in = in;
 
   if (!prim) __enable_irq();
+
+  return len;
 }
 
 /**
@@ -253,24 +280,43 @@ void usbSerialPutc(uint8_t c)
   */
 static uint16_t VCP_DataRx (uint8_t* Buf, uint32_t Len)
 {
-  if (receiveDataCb)
+  if (receiveDataCb) {
     receiveDataCb(Buf, Len);
-  
-// #if defined(CLI)
-//   // pass data to CLI
-//   cliReceiveData(Buf, Len);
-// #elif defined(LUA)  
-//   // copy data to the LUA FIFO
-//   if (luaRxFifo) {
-//     for (uint32_t i = 0; i < Len; i++) {
-//       luaRxFifo->push(Buf[i]);
-//     }
-//   }
-// #endif
+    return USBD_OK;
+  }
+
+  usbSerialRxFifo.push(Buf, Len);
+
+  if (!usbSerialRxFifo.hasSpace(CDC_DATA_OUT_PACKET_SIZE)) {
+    // the endpoint is re-armed by usbSerialRead()
+    usbSerialRxPaused = true;
+    return USBD_BUSY;
+  }
 
   return USBD_OK;
 }
 
+size_t usbSerialRead(uint8_t * buf, size_t len)
+{
+  size_t count = usbSerialRxFifo.pop(buf, len);
+
+  if (usbSerialRxPaused && usbSerialRxFifo.hasSpace(CDC_DATA_OUT_PACKET_SIZE)) {
+    NVIC_DisableIRQ(OTG_FS_IRQn);
+    usbSerialRxPaused = false;
+    if (cdcConnected) {
+      usbd_cdc_ResumeRx(&USB_OTG_dev);
+    }
+    NVIC_EnableIRQ(OTG_FS_IRQn);
+  }
+
+  return count;
+}
+
+size_t usbSerialRxAvailable()
+{
+  return usbSerialRxFifo.size();
+}
+
 uint32_t usbSerialBaudRate(void)
 {
     return g_lc.bitrate;
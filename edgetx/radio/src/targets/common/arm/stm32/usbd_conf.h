@@ -48,7 +48,9 @@
 #define HID_IN_EP                    0x81
 #define HID_OUT_EP                   0x01
 
-#define HID_IN_PACKET                19
+// the joystick report and its descriptor are built at runtime
+#define HID_IN_PACKET_MAX            64
+#define HID_REPORT_DESC_MAX_SIZE     128
 #define HID_OUT_PACKET               9
 
 #define CDC_IN_EP                    0x81  /* EP1 for data IN */
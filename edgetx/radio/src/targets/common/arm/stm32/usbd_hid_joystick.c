@@ -22,6 +22,7 @@
 #include "usbd_desc.h"
 #include "usbd_hid_core.h"
 #include "usbd_req.h"
+#include <string.h>
 
 /** @addtogroup STM32_USB_OTG_DEVICE_LIBRARY
   * @{
@@ -77,6 +78,8 @@ static uint8_t  USBD_HID_Setup (void  *pdev,
 static const uint8_t  *USBD_HID_GetCfgDesc (uint8_t speed, uint16_t *length);
 
 static uint8_t  USBD_HID_DataIn (void  *pdev, uint8_t epnum);
+
+static uint8_t  USBD_HID_SOF (void  *pdev);
 /**
   * @}
   */ 
@@ -89,57 +92,15 @@ static uint8_t  USBD_HID_DataIn (void  *pdev, uint8_t epnum);
   #endif
 #endif /* USB_OTG_HS_INTERNAL_DMA_ENABLED */ 
 /*
-  This USB HID endpoint report description defines a device with:
-    * 24 digital buttons
-    * 8 analog axes with 8bit resolution
-
-  Repot packet described as C struct is:
-
-  struct {
-    uint8_t buttons1; //bit 0 - button 1, bit 1 - button 2, ..., mapped to channels 9-16, on if channel > 0
-    uint8_t buttons2; // mapped to channels 17-24, on if channel > 0
-    uint8_t buttons3; // mapped to channels 25-32, on if channel > 0
-    uint8_t X;  //analog value, mapped to channel 1
-    uint8_t Y;  //analog value, mapped to channel 2
-    uint8_t Z;  //analog value, mapped to channel 3
-    uint8_t Rx; //analog value, mapped to channel 4
-    uint8_t Ry  //analog value, mapped to channel 5
-    uint8_t Rz; //analog value, mapped to channel 6
-    uint8_t S1; //analog value, mapped to channel 7
-    uint8_t S2; //analog value, mapped to channel 8
-  }
-*/ 
-__ALIGN_BEGIN static const uint8_t HID_JOYSTICK_ReportDesc[] __ALIGN_END =
-{
-    0x05, 0x01,                    //     USAGE_PAGE (Generic Desktop)
-    0x09, 0x05,                    //     USAGE (Game Pad)
-    0xa1, 0x01,                    //     COLLECTION (Application)
-    0xa1, 0x00,                    //       COLLECTION (Physical)
-    0x05, 0x09,                    //         USAGE_PAGE (Button)
-    0x19, 0x01,                    //         USAGE_MINIMUM (Button 1)
-    0x29, 0x18,                    //         USAGE_MAXIMUM (Button 24)
-    0x15, 0x00,                    //         LOGICAL_MINIMUM (0)
-    0x25, 0x01,                    //         LOGICAL_MAXIMUM (1)
-    0x95, 0x18,                    //         REPORT_COUNT (24)
-    0x75, 0x01,                    //         REPORT_SIZE (1)
-    0x81, 0x02,                    //         INPUT (Data,Var,Abs)
-    0x05, 0x01,                    //         USAGE_PAGE (Generic Desktop)
-    0x09, 0x30,                    //         USAGE (X)
-    0x09, 0x31,                    //         USAGE (Y)
-    0x09, 0x32,                    //         USAGE (Z)
-    0x09, 0x33,                    //         USAGE (Rx)
-    0x09, 0x34,                    //         USAGE (Ry)
-    0x09, 0x35,                    //         USAGE (Rz)
-    0x09, 0x36,                    //         USAGE (Slider)
-    0x09, 0x36,                    //         USAGE (Slider)
-    0x16, 0x00, 0x00,              //         LOGICAL_MINIMUM (0)
-    0x26, 0xFF, 0x07,              //         LOGICAL_MAXIMUM (2047)
-    0x75, 0x10,                    //         REPORT_SIZE (16)
-    0x95, 0x08,                    //         REPORT_COUNT (8)
-    0x81, 0x02,                    //         INPUT (Data,Var,Abs)
-    0xc0,                          //       END_COLLECTION
-    0xc0                           //     END_COLLECTION
-};
+  The report descriptor is generated at runtime (see usbJoystickStart() in
+  usb_driver.cpp) from the joystick configuration: buttons first, then the
+  analog axes. USBD_HID_SetReportDesc() must be called before USBD_Init().
+*/
+__ALIGN_BEGIN static uint8_t HID_JOYSTICK_ReportDesc[HID_REPORT_DESC_MAX_SIZE] __ALIGN_END;
+static uint16_t HID_JOYSTICK_ReportDescSize = 0;
+static uint16_t HID_JOYSTICK_InPacketSize = HID_IN_PACKET_MAX;
+
+static void (*HID_SOF_Callback)(void) = NULL;
 
 
 /** @defgroup USBD_HID_Private_Variables
@@ -155,7 +116,7 @@ const USBD_Class_cb_TypeDef  USBD_HID_cb =
   NULL, /*EP0_RxReady*/
   USBD_HID_DataIn, /*DataIn*/
   NULL, /*DataOut*/
-  NULL, /*SOF */
+  USBD_HID_SOF, /*SOF */
   NULL,
   NULL,      
   USBD_HID_GetCfgDesc,
@@ -191,7 +152,7 @@ __ALIGN_BEGIN static uint32_t  USBD_HID_IdleState __ALIGN_END = 0;
   #endif
 #endif /* USB_OTG_HS_INTERNAL_DMA_ENABLED */ 
 /* USB HID device Configuration Descriptor */
-__ALIGN_BEGIN static const uint8_t USBD_HID_CfgDesc[USB_HID_CONFIG_DESC_SIZ] __ALIGN_END =
+__ALIGN_BEGIN static uint8_t USBD_HID_CfgDesc[USB_HID_CONFIG_DESC_SIZ] __ALIGN_END =
 {
   0x09, /* bLength: Configuration Descriptor size */
   USB_CONFIGURATION_DESCRIPTOR_TYPE, /* bDescriptorType: Configuration */
@@ -225,7 +186,7 @@ __ALIGN_BEGIN static const uint8_t USBD_HID_CfgDesc[USB_HID_CONFIG_DESC_SIZ] __A
   0x00,         /*bCountryCode: Hardware target country*/
   0x01,         /*bNumDescriptors: Number of HID class descriptors to follow*/
   0x22,         /*bDescriptorType*/
-  sizeof(HID_JOYSTICK_ReportDesc),/*wItemLength: Total length of Report descriptor*/
+  0x00,         /*wItemLength: Total length of Report descriptor, set by USBD_HID_SetReportDesc()*/
   0x00,
   /******************** Descriptor of Mouse endpoint ********************/
   /* 27 */
@@ -234,7 +195,7 @@ __ALIGN_BEGIN static const uint8_t USBD_HID_CfgDesc[USB_HID_CONFIG_DESC_SIZ] __A
   
   HID_IN_EP,     /*bEndpointAddress: Endpoint Address (IN)*/
   0x03,          /*bmAttributes: Interrupt endpoint*/
-  HID_IN_PACKET, /*wMaxPacketSize: 4 Byte max */
+  HID_IN_PACKET_MAX, /*wMaxPacketSize: set by USBD_HID_SetReportDesc() */
   0x00,
   0x01,          /*bInterval: Polling Interval (1 ms)*/
   /* 34 */
@@ -266,7 +227,7 @@ static uint8_t  USBD_HID_Init (void  *pdev,
   /* Open EP IN */
   DCD_EP_Open(pdev,
               HID_IN_EP,
-              HID_IN_PACKET,
+              HID_JOYSTICK_InPacketSize,
               USB_OTG_EP_INT);
   
   /* Open EP OUT */
@@ -349,7 +310,7 @@ static uint8_t  USBD_HID_Setup (void  *pdev,
     case USB_REQ_GET_DESCRIPTOR: 
       if( req->wValue >> 8 == HID_REPORT_DESC)
       {
-        len = MIN(sizeof(HID_JOYSTICK_ReportDesc) , req->wLength);
+        len = MIN(HID_JOYSTICK_ReportDescSize , req->wLength);
         pbuf = HID_JOYSTICK_ReportDesc; // wiiccReportDescriptor; //
       }
       else if( req->wValue >> 8 == HID_DESCRIPTOR_TYPE)
@@ -405,6 +366,42 @@ uint8_t USBD_HID_SendReport(USB_OTG_CORE_HANDLE  *pdev, uint8_t * report, uint16
   return USBD_FAIL;
 }
 
+/**
+  * @brief  USBD_HID_SetReportDesc
+  *         Set the report descriptor and the size of the IN reports
+  * @param  desc: report descriptor, copied
+  * @param  len: report descriptor length
+  * @param  inPacketSize: size of the reports sent with USBD_HID_SendReport()
+  */
+void USBD_HID_SetReportDesc(const uint8_t * desc, uint16_t len, uint16_t inPacketSize)
+{
+  if (len > HID_REPORT_DESC_MAX_SIZE)
+    len = HID_REPORT_DESC_MAX_SIZE;
+  if (inPacketSize > HID_IN_PACKET_MAX)
+    inPacketSize = HID_IN_PACKET_MAX;
+
+  memcpy(HID_JOYSTICK_ReportDesc, desc, len);
+  HID_JOYSTICK_ReportDescSize = len;
+  HID_JOYSTICK_InPacketSize = inPacketSize;
+
+  /* wItemLength of the HID descriptor */
+  USBD_HID_CfgDesc[25] = LOBYTE(len);
+  USBD_HID_CfgDesc[26] = HIBYTE(len);
+  /* wMaxPacketSize of the IN endpoint */
+  USBD_HID_CfgDesc[31] = LOBYTE(inPacketSize);
+  USBD_HID_CfgDesc[32] = HIBYTE(inPacketSize);
+}
+
+/**
+  * @brief  USBD_HID_SetSOFCallback
+  *         Set the function called (from the USB interrupt) on each
+  *         start of frame, i.e. every 1ms on a full speed bus
+  */
+void USBD_HID_SetSOFCallback(void (*cb)(void))
+{
+  HID_SOF_Callback = cb;
+}
+
 /**
   * @brief  USBD_HID_GetCfgDesc 
   *         return configuration descriptor
@@ -438,6 +435,20 @@ static uint8_t  USBD_HID_DataIn (void  *pdev,
   return USBD_OK;
 }
 
+/**
+  * @brief  USBD_HID_SOF
+  *         handle SOF event
+  * @param  pdev: device instance
+  * @retval status
+  */
+static uint8_t  USBD_HID_SOF (void  *pdev)
+{
+  if (HID_SOF_Callback) {
+    HID_SOF_Callback();
+  }
+  return USBD_OK;
+}
+
 /**
   * @}
   */ 
@@ -287,6 +287,11 @@ void boardInit()
 
 void boardOff()
 {
+#if defined(DISK_CACHE) && !defined(BOOT)
+  // nothing left to write after a normal shutdown
+  diskCache.flush();
+#endif
+
   backlightEnable(0);
 
   while (pwrPressed()) {
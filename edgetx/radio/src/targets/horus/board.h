@@ -572,6 +572,7 @@ void DMAFillRect(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, ui
 void DMACopyBitmap(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, const uint16_t * src, uint16_t srcw, uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w, uint16_t h);
 void DMACopyAlphaBitmap(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, const uint16_t * src, uint16_t srcw, uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w, uint16_t h);
 void DMABitmapConvert(uint16_t * dest, const uint8_t * src, uint16_t w, uint16_t h, uint32_t format);
+void DMAInit();
 void lcdStoreBackupBuffer();
 int lcdRestoreBackupBuffer();
 void lcdSetContrast();
@@ -753,7 +754,7 @@ void gpsSendByte(uint8_t byte);
 #define USART_FLAG_ERRORS              (USART_FLAG_ORE | USART_FLAG_NE | USART_FLAG_FE | USART_FLAG_PE)
 
 // BT driver
-#define BT_TX_FIFO_SIZE    64
+#define BT_TX_FIFO_SIZE    128
 #define BT_RX_FIFO_SIZE    256
 #define BLUETOOTH_BOOTLOADER_BAUDRATE  230400
 #define BLUETOOTH_FACTORY_BAUDRATE     57600
@@ -770,6 +771,15 @@ extern DMAFifo<512> telemetryFifo;
 typedef DMAFifo<32> AuxSerialRxFifo;
 extern AuxSerialRxFifo auxSerialRxFifo;
 extern AuxSerialRxFifo aux2SerialRxFifo;
+#define AUX_SERIAL_TX_FIFO_SIZE 512
+typedef Fifo<uint8_t, AUX_SERIAL_TX_FIFO_SIZE> AuxSerialTxFifo;
+extern AuxSerialTxFifo auxSerialTxFifo;
+extern AuxSerialTxFifo aux2SerialTxFifo;
+#if defined(BT_DMA_Stream_RX)
+typedef DMAFifo<BT_RX_FIFO_SIZE> BluetoothRxFifo;
+#else
+typedef Fifo<uint8_t, BT_RX_FIFO_SIZE> BluetoothRxFifo;
+#endif
 extern volatile uint32_t externalModulePort;
 #endif
 
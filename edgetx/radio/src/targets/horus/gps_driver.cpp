@@ -111,8 +111,8 @@ uint8_t gpsGetByte(uint8_t * byte)
 {
   uint8_t result = gpsRxFifo.pop(*byte);
 #if defined(DEBUG)
-  if (gpsTraceEnabled) {
-    serialPutc(*byte);
+  if (gpsTraceEnabled && result) {
+    serialWrite((const char *)byte, 1);
   }
 #endif
   return result;
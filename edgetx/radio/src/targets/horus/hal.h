@@ -972,16 +972,23 @@
 #define BT_TX_GPIO_PinSource            GPIO_PinSource14
 #define BT_RX_GPIO_PinSource            GPIO_PinSource9
 #define BT_USART_IRQHandler             USART6_IRQHandler
+#define BT_DMA_Stream_RX                DMA2_Stream1
+#define BT_DMA_Channel_RX               DMA_Channel_5
+#define BT_DMA_Stream_TX                DMA2_Stream6
+#define BT_DMA_Channel_TX               DMA_Channel_5
+#define BT_DMA_TX_Stream_IRQn           DMA2_Stream6_IRQn
+#define BT_DMA_TX_IRQHandler            DMA2_Stream6_IRQHandler
+#define BT_DMA_TX_FLAG_TC               DMA_IT_TCIF6
 #else
 #define BT_RCC_APB2Periph               0
 #endif
 #if defined(PCBX12S)
   #if PCBREV >= 13
-    #define BT_RCC_AHB1Periph           (RCC_AHB1Periph_GPIOI | RCC_AHB1Periph_GPIOG)
+    #define BT_RCC_AHB1Periph           (RCC_AHB1Periph_GPIOI | RCC_AHB1Periph_GPIOG | RCC_AHB1Periph_DMA2)
     #define BT_EN_GPIO                  GPIOI
     #define BT_EN_GPIO_PIN              GPIO_Pin_10 // PI.10
   #else
-    #define BT_RCC_AHB1Periph           (RCC_AHB1Periph_GPIOA | RCC_AHB1Periph_GPIOG)
+    #define BT_RCC_AHB1Periph           (RCC_AHB1Periph_GPIOA | RCC_AHB1Periph_GPIOG | RCC_AHB1Periph_DMA2)
     #define BT_EN_GPIO                  GPIOA
     #define BT_EN_GPIO_PIN              GPIO_Pin_6 // PA.06
   #endif
@@ -990,7 +997,7 @@
   #define BT_BCTS_GPIO                  GPIOG
   #define BT_BCTS_GPIO_PIN              GPIO_Pin_11 // PG.11
 #elif defined(PCBX10)
-  #define BT_RCC_AHB1Periph             RCC_AHB1Periph_GPIOG
+  #define BT_RCC_AHB1Periph             (RCC_AHB1Periph_GPIOG | RCC_AHB1Periph_DMA2)
   #define BT_EN_GPIO                    GPIOG
   #define BT_EN_GPIO_PIN                GPIO_Pin_10 // PG.10
 #endif
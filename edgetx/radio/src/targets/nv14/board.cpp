@@ -203,6 +203,11 @@ void boardInit()
 
 void boardOff()
 {
+#if defined(DISK_CACHE) && !defined(BOOT)
+  // nothing left to write after a normal shutdown
+  diskCache.flush();
+#endif
+
   lcd->drawFilledRect(0, 0, LCD_WIDTH, LCD_HEIGHT, SOLID, COLOR_THEME_FOCUS);
   lcdOff();
 
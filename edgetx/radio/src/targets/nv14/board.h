@@ -422,6 +422,7 @@ void DMAFillRect(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, ui
 void DMACopyBitmap(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, const uint16_t * src, uint16_t srcw, uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w, uint16_t h);
 void DMACopyAlphaBitmap(uint16_t * dest, uint16_t destw, uint16_t desth, uint16_t x, uint16_t y, const uint16_t * src, uint16_t srcw, uint16_t srch, uint16_t srcx, uint16_t srcy, uint16_t w, uint16_t h);
 void DMABitmapConvert(uint16_t * dest, const uint8_t * src, uint16_t w, uint16_t h, uint32_t format);
+void DMAInit();
 void lcdStoreBackupBuffer();
 int lcdRestoreBackupBuffer();
 void lcdSetContrast();
@@ -551,6 +552,9 @@ void checkTrainerSettings();
 extern DMAFifo<512> telemetryFifo;
 typedef Fifo<uint8_t, 32> AuxSerialRxFifo;
 extern AuxSerialRxFifo auxSerialRxFifo;
+#define AUX_SERIAL_TX_FIFO_SIZE 512
+typedef Fifo<uint8_t, AUX_SERIAL_TX_FIFO_SIZE> AuxSerialTxFifo;
+extern AuxSerialTxFifo auxSerialTxFifo;
 #endif
 
 // Touch panel driver
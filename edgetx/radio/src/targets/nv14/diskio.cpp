@@ -129,6 +129,7 @@ DRESULT disk_read_dma(BYTE drv, BYTE * buff, DWORD sector, UINT count)
   DRESULT res;
   SD_Error Status;
   SDTransferState State;
+  EVENT_TRACE_BEGIN(EVENT_TRACE_SD_READ, sector);
   for (int retry=0; retry<3; retry++) {
     res = RES_OK;
     if (count == 1) {
@@ -156,6 +157,7 @@ DRESULT disk_read_dma(BYTE drv, BYTE * buff, DWORD sector, UINT count)
     if (res == RES_OK) break;
     sdReadRetries += 1;
   }
+  EVENT_TRACE_END(EVENT_TRACE_SD_READ);
   return res;
 }
 
@@ -235,6 +237,8 @@ DRESULT __disk_write(
     return(res);
   }
 
+  EVENT_TRACE_BEGIN(EVENT_TRACE_SD_WRITE, sector);
+
   if (count == 1) {
     Status = SD_WriteBlock((uint8_t *)buff, sector, BLOCK_SIZE); // 4GB Compliant
   }
@@ -258,6 +262,8 @@ DRESULT __disk_write(
     res = RES_ERROR;
   }
 
+  EVENT_TRACE_END(EVENT_TRACE_SD_WRITE);
+
   // TRACE("result=%d", res);
   return res;
 }
@@ -297,8 +303,9 @@ DRESULT disk_ioctl (
       break;
 
     case CTRL_SYNC:
+      // called by f_sync() / f_close(): the cached writes must reach the card
+      res = diskCache.sync(drv);
       while (SD_GetStatus() == SD_TRANSFER_BUSY); /* Complete pending write process (needed at _FS_READONLY == 0) */
-      res = RES_OK;
       break;
 
     default:
@@ -364,6 +371,9 @@ void sdDone()
     audioQueue.stopSD();
 #if defined(LOG_TELEMETRY)
     f_close(&g_telemetryFile);
+#endif
+#if defined(DISK_CACHE)
+    diskCache.flush();
 #endif
     f_mount(NULL, "", 0); // unmount SD
   }
@@ -729,7 +729,7 @@ bool isJackPlugged()
 
 void serialPrintf(const char * format, ...) { }
 void serialCrlf() { }
-void serialPutc(char c) { }
+void serialWrite(const char * buf, size_t len) { }
 
 uint16_t getBatteryVoltage()
 {
@@ -798,8 +798,19 @@ void rtcSetTime(const struct gtm * t)
 }
 
 #if defined(USB_SERIAL)
-void usbSerialPutc(uint8_t c)
+size_t usbSerialWrite(const uint8_t * buf, size_t len)
 {
+  return len;
+}
+
+size_t usbSerialRead(uint8_t * buf, size_t len)
+{
+  return 0;
+}
+
+size_t usbSerialRxAvailable()
+{
+  return 0;
 }
 #endif
 
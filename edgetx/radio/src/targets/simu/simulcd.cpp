@@ -110,6 +110,9 @@ void lcdInit()
   _lcd2.clear();
 }
 
+// DMA2D transfers are emulated
+void DMAInit() {}
+
 void DMAFillRect(uint16_t *dest, uint16_t destw, uint16_t desth, uint16_t x,
                  uint16_t y, uint16_t w, uint16_t h, uint16_t color)
 {
@@ -927,7 +927,7 @@ void auxSerialStop();
 #else
 #define BLUETOOTH_FACTORY_BAUDRATE      57600
 #endif
-#define BT_TX_FIFO_SIZE    64
+#define BT_TX_FIFO_SIZE    128
 #define BT_RX_FIFO_SIZE    256
 void bluetoothInit(uint32_t baudrate, bool enable);
 void bluetoothWriteWakeup();
@@ -1039,6 +1039,10 @@ void setTopBatteryValue(uint32_t volts);
 extern Fifo<uint8_t, TELEMETRY_FIFO_SIZE> telemetryFifo;
 typedef DMAFifo<32> AuxSerialRxFifo;
 extern AuxSerialRxFifo auxSerialRxFifo;
+#define AUX_SERIAL_TX_FIFO_SIZE 512
+typedef Fifo<uint8_t, AUX_SERIAL_TX_FIFO_SIZE> AuxSerialTxFifo;
+extern AuxSerialTxFifo auxSerialTxFifo;
+typedef Fifo<uint8_t, BT_RX_FIFO_SIZE> BluetoothRxFifo;
 #endif
 
 // Gyro driver
@@ -691,7 +691,9 @@ DRESULT disk_read (
 {
   if (drv || !count) return RES_PARERR;
   if (Stat & STA_NOINIT) return RES_NOTRDY;
+  EVENT_TRACE_BEGIN(EVENT_TRACE_SD_READ, sector);
   int8_t res = SD_ReadSectors(buff, sector, count);
+  EVENT_TRACE_END(EVENT_TRACE_SD_READ);
   TRACE_SD_CARD_EVENT((res != 0), sd_disk_read, (count << 24) + (sector & 0x00FFFFFF));
   return (res != 0) ? RES_ERROR : RES_OK;
 }
@@ -746,7 +748,9 @@ DRESULT disk_write (
   if (drv || !count) return RES_PARERR;
   if (Stat & STA_NOINIT) return RES_NOTRDY;
   if (Stat & STA_PROTECT) return RES_WRPRT;
+  EVENT_TRACE_BEGIN(EVENT_TRACE_SD_WRITE, sector);
   int8_t res = SD_WriteSectors(buff, sector, count);
+  EVENT_TRACE_END(EVENT_TRACE_SD_WRITE);
   TRACE_SD_CARD_EVENT((res != 0), sd_disk_write, (count << 24) + (sector & 0x00FFFFFF));
   return (res != 0) ? RES_ERROR : RES_OK;
 }
@@ -184,6 +184,7 @@ void extmoduleSendBuffer(const uint8_t * data, uint8_t size)
 #define USART_FLAG_ERRORS (USART_FLAG_ORE | USART_FLAG_NE | USART_FLAG_FE | USART_FLAG_PE)
 extern "C" void EXTMODULE_USART_IRQHandler(void)
 {
+  EVENT_TRACE_ISR(EVENT_TRACE_ISR_EXTMODULE);
   uint32_t status = EXTMODULE_USART->SR;
 
   while (status & (USART_FLAG_RXNE | USART_FLAG_ERRORS)) {
@@ -364,6 +365,8 @@ void extmoduleSendNextFrame()
       EXTMODULE_TIMER->DIER |= TIM_DIER_CC2IE;
       break;
   }
+
+  LATENCY_PROBE_FRAME(EXTERNAL_MODULE);
 }
 
 void extmoduleSendInvertedByte(uint8_t byte)
@@ -400,6 +403,7 @@ void extmoduleSendInvertedByte(uint8_t byte)
 
 extern "C" void EXTMODULE_TIMER_DMA_STREAM_IRQHandler()
 {
+  EVENT_TRACE_ISR(EVENT_TRACE_ISR_EXTMODULE);
   if (!DMA_GetITStatus(EXTMODULE_TIMER_DMA_STREAM, EXTMODULE_TIMER_DMA_FLAG_TC))
     return;
 
@@ -415,6 +419,7 @@ extern "C" void EXTMODULE_TIMER_DMA_STREAM_IRQHandler()
 
 extern "C" void EXTMODULE_TIMER_CC_IRQHandler()
 {
+  EVENT_TRACE_ISR(EVENT_TRACE_ISR_EXTMODULE);
   EXTMODULE_TIMER->DIER &= ~TIM_DIER_CC2IE; // Stop this interrupt
   EXTMODULE_TIMER->SR &= ~TIM_SR_CC2IF;
 
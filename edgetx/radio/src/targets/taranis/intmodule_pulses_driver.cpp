@@ -149,6 +149,7 @@ void intmoduleSendNextFramePPM(const uint8_t* data, uint8_t size)
 
 extern "C" void INTMODULE_DMA_STREAM_IRQHandler()
 {
+  EVENT_TRACE_ISR(EVENT_TRACE_ISR_INTMODULE);
   if (!DMA_GetITStatus(INTMODULE_DMA_STREAM, INTMODULE_DMA_FLAG_TC))
     return;
 
@@ -164,6 +165,7 @@ extern "C" void INTMODULE_DMA_STREAM_IRQHandler()
 
 extern "C" void INTMODULE_TIMER_CC_IRQHandler()
 {
+  EVENT_TRACE_ISR(EVENT_TRACE_ISR_INTMODULE);
   INTMODULE_TIMER->DIER &= ~TIM_DIER_CC2IE; // Stop this interrupt
   INTMODULE_TIMER->SR &= ~TIM_SR_CC2IF;
   if (setupPulsesInternalModule()) {
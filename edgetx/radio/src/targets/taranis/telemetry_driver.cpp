@@ -313,6 +313,7 @@ void sportSendBuffer(const uint8_t * buffer, uint32_t count)
 extern "C" void TELEMETRY_DMA_TX_IRQHandler(void)
 {
   DEBUG_INTERRUPT(INT_TELEM_DMA);
+  EVENT_TRACE_ISR(EVENT_TRACE_ISR_TELEMETRY);
   if (DMA_GetITStatus(TELEMETRY_DMA_Stream_TX, TELEMETRY_DMA_TX_FLAG_TC)) {
     DMA_ClearITPendingBit(TELEMETRY_DMA_Stream_TX, TELEMETRY_DMA_TX_FLAG_TC);
 
@@ -330,6 +331,7 @@ extern "C" void TELEMETRY_DMA_TX_IRQHandler(void)
 extern "C" void TELEMETRY_USART_IRQHandler(void)
 {
   DEBUG_INTERRUPT(INT_TELEM_USART);
+  EVENT_TRACE_ISR(EVENT_TRACE_ISR_TELEMETRY);
   uint32_t status = TELEMETRY_USART->SR;
 
   if ((status & USART_SR_TC) && (TELEMETRY_USART->CR1 & USART_CR1_TCIE)) {
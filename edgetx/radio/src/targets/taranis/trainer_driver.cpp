@@ -151,6 +151,7 @@ extern "C" void TRAINER_DMA_IRQHandler()
 extern "C" void TRAINER_TIMER_IRQHandler()
 {
   DEBUG_INTERRUPT(INT_TRAINER);
+  EVENT_TRACE_ISR(EVENT_TRACE_ISR_TRAINER);
 
   uint16_t capture = 0;
   bool doCapture = false;
@@ -99,15 +99,21 @@ void sendSynchronousPulses(uint8_t runMask)
 {
 #if defined(HARDWARE_INTERNAL_MODULE)
   if ((runMask & (1 << INTERNAL_MODULE)) && isModuleSynchronous(INTERNAL_MODULE)) {
-    if (setupPulsesInternalModule())
+    mixerSchedulerFrameBegin(INTERNAL_MODULE);
+    if (setupPulsesInternalModule()) {
       intmoduleSendNextFrame();
+      mixerSchedulerFrameEnd(INTERNAL_MODULE);
+    }
   }
 #endif
 
 #if defined(HARDWARE_EXTERNAL_MODULE)
   if ((runMask & (1 << EXTERNAL_MODULE)) && isModuleSynchronous(EXTERNAL_MODULE)) {
-    if (setupPulsesExternalModule())
+    mixerSchedulerFrameBegin(EXTERNAL_MODULE);
+    if (setupPulsesExternalModule()) {
       extmoduleSendNextFrame();
+      mixerSchedulerFrameEnd(EXTERNAL_MODULE);
+    }
   }
 #endif
 }
@@ -132,7 +138,9 @@ void execMixerFrequentActions()
 
   if (!s_pulses_paused) {
     DEBUG_TIMER_START(debugTimerTelemetryWakeup);
+    EVENT_TRACE_BEGIN(EVENT_TRACE_TELEMETRY, 0);
     telemetryWakeup();
+    EVENT_TRACE_END(EVENT_TRACE_TELEMETRY);
     DEBUG_TIMER_STOP(debugTimerTelemetryWakeup);
   }
 }
@@ -180,15 +188,17 @@ TASK_FUNCTION(mixerTask)
       uint16_t t0 = getTmr2MHz();
 
       DEBUG_TIMER_START(debugTimerMixer);
+      EVENT_TRACE_BEGIN(EVENT_TRACE_MIXER, 0);
       RTOS_LOCK_MUTEX(mixerMutex);
 
       doMixerCalculations();
-      sendSynchronousPulses((1 << INTERNAL_MODULE) | (1 << EXTERNAL_MODULE));
+      sendSynchronousPulses(mixerSchedulerGetDueModules());
       doMixerPeriodicUpdates();
 
       DEBUG_TIMER_START(debugTimerMixerCalcToUsage);
       DEBUG_TIMER_SAMPLE(debugTimerMixerIterval);
       RTOS_UNLOCK_MUTEX(mixerMutex);
+      EVENT_TRACE_END(EVENT_TRACE_MIXER);
       DEBUG_TIMER_STOP(debugTimerMixer);
 
 #if defined(STM32) && !defined(SIMU)
@@ -246,6 +256,7 @@ TASK_FUNCTION(menusTask)
 #endif
     uint32_t start = (uint32_t)RTOS_GET_TIME();
     DEBUG_TIMER_START(debugTimerPerMain);
+    EVENT_TRACE_BEGIN(EVENT_TRACE_PER_MAIN, 0);
 #if defined(COLORLCD) && defined(CLI)
     if (perMainEnabled) {
       perMain();
@@ -253,6 +264,7 @@ TASK_FUNCTION(menusTask)
 #else
     perMain();
 #endif
+    EVENT_TRACE_END(EVENT_TRACE_PER_MAIN);
     DEBUG_TIMER_STOP(debugTimerPerMain);
     // TODO remove completely massstorage from sky9x firmware
     uint32_t runtime = ((uint32_t)RTOS_GET_TIME() - start);
@@ -264,6 +264,8 @@ constexpr uint8_t START_STOP    = 0x7E;
 constexpr uint8_t BYTE_STUFF    = 0x7D;
 constexpr uint8_t STUFF_MASK    = 0x20;
 constexpr uint8_t TRAINER_FRAME = 0x80;
+constexpr uint8_t TRAINER_FRAME_V2 = 0x81;
+constexpr uint8_t TRAINER_HELLO_V2 = 0x82;
 
 typedef enum {
   TS_IDLE = 0,  // waiting for 0x5e frame marker
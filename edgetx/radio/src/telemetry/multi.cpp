@@ -292,8 +292,10 @@ static void processMultiRxChannels(const uint8_t * data, uint8_t len)
       break;
   }
 
-  if (ch == maxCh)
+  if (ch == maxCh) {
     ppmInputValidityTimer = PPM_IN_VALID_TIMEOUT;
+    LATENCY_PROBE_INPUT();
+  }
 }
 #endif
 
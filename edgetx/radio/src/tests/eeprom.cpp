@@ -20,6 +20,7 @@
  */
 
 #include "gtests.h"
+#include "location.h"
 
 extern const char * eepromFile;
 
@@ -38,11 +39,38 @@ extern Backup::RamBackupUncompressed ramBackupUncompressed;
 TEST(Storage, BackupAndRestore)
 {
   rambackupWrite();
-  Backup::RamBackupUncompressed ramBackupRestored;
-  if (uncompress((uint8_t *)&ramBackupRestored, sizeof(ramBackupRestored), ramBackup->data, ramBackup->size) != sizeof(ramBackupUncompressed))
-    TRACE("ERROR uncompress");
-  if (memcmp(&ramBackupUncompressed, &ramBackupRestored, sizeof(ramBackupUncompressed)) != 0)
-    TRACE("ERROR restore");
+  Backup::RamBackupUncompressed ramBackupSaved;
+  memcpy(&ramBackupSaved, &ramBackupUncompressed, sizeof(ramBackupUncompressed));
+  memset(&ramBackupUncompressed, 0, sizeof(ramBackupUncompressed));
+  EXPECT_TRUE(rambackupRestore());
+  EXPECT_EQ(0, memcmp(&ramBackupSaved, &ramBackupUncompressed, sizeof(ramBackupUncompressed)));
+}
+
+TEST(Storage, BackupIncrementalWrite)
+{
+  rambackupWrite();
+  uint16_t size = ramBackup->size;
+  ModelHeader header = g_model.header;
+  int16_t failsafe = g_model.failsafeChannels[MAX_OUTPUT_CHANNELS - 1];
+
+  // one chunk at the beginning, one at the end of the model
+  strncpy(g_model.header.name, "Backup", sizeof(g_model.header.name));
+  g_model.failsafeChannels[MAX_OUTPUT_CHANNELS - 1] = 1000;
+  rambackupWrite();
+
+  Backup::RamBackupUncompressed ramBackupSaved;
+  memcpy(&ramBackupSaved, &ramBackupUncompressed, sizeof(ramBackupUncompressed));
+  memset(&ramBackupUncompressed, 0, sizeof(ramBackupUncompressed));
+  EXPECT_TRUE(rambackupRestore());
+  EXPECT_EQ(0, memcmp(&ramBackupSaved, &ramBackupUncompressed, sizeof(ramBackupUncompressed)));
+  EXPECT_EQ(0, strncmp(g_model.header.name, "Backup", sizeof(g_model.header.name)));
+  EXPECT_EQ(1000, g_model.failsafeChannels[MAX_OUTPUT_CHANNELS - 1]);
+
+  // back to the original values
+  g_model.header = header;
+  g_model.failsafeChannels[MAX_OUTPUT_CHANNELS - 1] = failsafe;
+  rambackupWrite();
+  EXPECT_EQ(size, ramBackup->size);
 }
 #endif
 
@@ -186,3 +214,50 @@ TEST(Eeprom, rm)
   EXPECT_EQ(sz, 0);
 }
 #endif
+
+#if defined(SDCARD_YAML)
+#include "storage/sdcard_yaml.h"
+
+TEST(Storage, ModelJournal)
+{
+  simuFatfsSetPaths(TESTS_BUILD_PATH "/", TESTS_BUILD_PATH "/");
+  sdCheckAndCreateDirectory(MODELS_PATH);
+
+  char filename[] = "journal.yml";
+  memset(&g_model, 0, sizeof(g_model));
+  strncpy(g_model.header.name, "Journal", sizeof(g_model.header.name));
+  g_model.timers[1].start = 60;
+  EXPECT_EQ(nullptr, writeModelYaml(filename));
+  EXPECT_FALSE(isModelJournalPending());
+
+  // only the modified nodes are appended to the journal
+  strncpy(g_model.header.name, "Journal2", sizeof(g_model.header.name));
+  g_model.timers[0].start = 120;
+  g_model.timers[1].start = 0;
+  g_model.flightModeData[1].gvars[0] = 10;
+  EXPECT_EQ(nullptr, writeModelYaml(filename, false));
+  EXPECT_TRUE(isModelJournalPending());
+
+  memset(&g_model, 0, sizeof(g_model));
+  EXPECT_EQ(nullptr, readModelYaml(filename, (uint8_t *)&g_model, sizeof(g_model)));
+  EXPECT_STRNEQ("Journal2", g_model.header.name);
+  EXPECT_EQ(120, g_model.timers[0].start);
+  EXPECT_EQ(0, g_model.timers[1].start);
+  EXPECT_EQ(10, g_model.flightModeData[1].gvars[0]);
+
+  // the journal is merged back into the model file
+  EXPECT_EQ(nullptr, writeModelYaml(filename));
+  EXPECT_FALSE(isModelJournalPending());
+  FILINFO fno;
+  EXPECT_NE(FR_OK, f_stat(MODELS_PATH "/journal.yml.jnl", &fno));
+
+  memset(&g_model, 0, sizeof(g_model));
+  EXPECT_EQ(nullptr, readModelYaml(filename, (uint8_t *)&g_model, sizeof(g_model)));
+  EXPECT_STRNEQ("Journal2", g_model.header.name);
+  EXPECT_EQ(120, g_model.timers[0].start);
+  EXPECT_EQ(10, g_model.flightModeData[1].gvars[0]);
+
+  f_unlink(MODELS_PATH "/journal.yml");
+  simuFatfsSetPaths("", "");
+}
+#endif
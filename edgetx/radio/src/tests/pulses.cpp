@@ -0,0 +1,319 @@
+/*
+ * Copyright (C) EdgeTX
+ *
+ * Based on code named
+ *   opentx - https://github.com/opentx/opentx
+ *   th9x - http://code.google.com/p/th9x
+ *   er9x - http://code.google.com/p/er9x
+ *   gruvin9x - http://code.google.com/p/gruvin9x
+ *
+ * License GPLv2: http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "gtests.h"
+#include "location.h"
+
+// Golden frames of the pulses builders
+//
+// Each protocol is fed with the same channel outputs: full range first,
+// then pseudo-random values from a fixed seed, a bit beyond the limits to
+// check the clipping. The frames are compared with the ones stored in
+// tests/pulses_<protocol>.bin, each frame preceded by its size (16 bit
+// little endian). Pulses trains are stored as 16 bit little endian values.
+// On mismatch the new frames are saved in /tmp, to be checked and copied
+// over the reference when the change is intended.
+//
+// The PulsesBench tests are disabled by default, "make bench-pulses"
+// runs them and prints the encode time per frame.
+
+#define PULSES_GOLDEN_FRAMES           16
+#define PULSES_BENCH_FRAMES            20000
+
+typedef std::vector<uint8_t> PulsesFrames;
+
+struct PulsesProtocol
+{
+  const char * name;
+  void (* setup)();
+  void (* encode)(PulsesFrames * frames);  // frames may be nullptr (bench)
+};
+
+static uint32_t pulsesRandomSeed;
+
+static int16_t pulsesRandomValue()
+{
+  // same LCG on all hosts
+  pulsesRandomSeed = pulsesRandomSeed * 1103515245 + 12345;
+  return int((pulsesRandomSeed >> 16) % 2561) - 1280;
+}
+
+static void setPulsesChannelOutputs(int frame)
+{
+  for (int i = 0; i < MAX_OUTPUT_CHANNELS; i++) {
+    switch (frame) {
+      case 0:
+        channelOutputs[i] = 0;
+        break;
+      case 1:
+        channelOutputs[i] = -1024;
+        break;
+      case 2:
+        channelOutputs[i] = 1024;
+        break;
+      case 3:
+        channelOutputs[i] = -1024 + (2048 / MAX_OUTPUT_CHANNELS) * i;
+        break;
+      default:
+        channelOutputs[i] = pulsesRandomValue();
+        break;
+    }
+  }
+}
+
+static void addFrameSize(PulsesFrames * frames, unsigned size)
+{
+  frames->push_back(size);
+  frames->push_back(size >> 8);
+}
+
+static void addFrame(PulsesFrames * frames, const uint8_t * data, unsigned size)
+{
+  if (frames) {
+    addFrameSize(frames, size);
+    frames->insert(frames->end(), data, data + size);
+  }
+}
+
+template <class T>
+static void addPulsesFrame(PulsesFrames * frames, const T * pulses, unsigned count)
+{
+  if (frames) {
+    addFrameSize(frames, 2 * count);
+    for (unsigned i = 0; i < count; i++) {
+      frames->push_back(pulses[i]);
+      frames->push_back(pulses[i] >> 8);
+    }
+  }
+}
+
+static void setupPulsesModule(uint8_t moduleIdx, uint8_t type, uint8_t subType)
+{
+  memclear(&g_model.moduleData[moduleIdx], sizeof(ModuleData));
+  g_model.moduleData[moduleIdx].type = type;
+  g_model.moduleData[moduleIdx].subType = subType;
+  g_model.moduleData[moduleIdx].channelsCount = 8;  // 16 channels
+  g_model.moduleData[moduleIdx].failsafeMode = FAILSAFE_NOT_SET;
+  g_model.header.modelId[moduleIdx] = 5;
+  moduleState[moduleIdx].protocol = PROTOCOL_CHANNELS_UNINITIALIZED;
+  moduleState[moduleIdx].mode = MODULE_MODE_NORMAL;
+  moduleState[moduleIdx].counter = 0;
+}
+
+static bool checkFrames(const char * name, const PulsesFrames & frames)
+{
+  std::string filename = std::string("pulses_") + name + ".bin";
+  PulsesFrames reference;
+
+  FILE * f = fopen((TESTS_PATH "/" + filename).c_str(), "rb");
+  if (f) {
+    uint8_t buffer[256];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+      reference.insert(reference.end(), buffer, buffer + count);
+    }
+    fclose(f);
+  }
+
+  if (frames == reference) {
+    return true;
+  }
+
+  f = fopen(("/tmp/" + filename).c_str(), "wb");
+  if (f) {
+    fwrite(frames.data(), 1, frames.size(), f);
+    fclose(f);
+  }
+  return false;
+}
+
+static void checkProtocol(const PulsesProtocol & protocol)
+{
+  PulsesFrames frames;
+
+  pulsesRandomSeed = 0x12345678;
+  protocol.setup();
+  for (int i = 0; i < PULSES_GOLDEN_FRAMES; i++) {
+    setPulsesChannelOutputs(i);
+    protocol.encode(&frames);
+  }
+
+  EXPECT_TRUE(checkFrames(protocol.name, frames))
+      << "frames differ from tests/pulses_" << protocol.name << ".bin, new ones saved in /tmp";
+}
+
+static void benchProtocol(const PulsesProtocol & protocol)
+{
+  using namespace std::chrono;
+
+  pulsesRandomSeed = 0x12345678;
+  protocol.setup();
+  nanoseconds elapsed(0);
+  for (int i = 0; i < PULSES_BENCH_FRAMES; i++) {
+    setPulsesChannelOutputs(4 + i % 64);
+    auto start = steady_clock::now();
+    protocol.encode(nullptr);
+    elapsed += steady_clock::now() - start;
+  }
+
+  printf("%-12s %8.0f ns/frame\n", protocol.name,
+         double(elapsed.count()) / PULSES_BENCH_FRAMES);
+}
+
+#if defined(CROSSFIRE)
+uint8_t createCrossfireChannelsFrame(uint8_t * frame, int16_t * pulses);
+
+static const PulsesProtocol crossfireProtocol = {
+  "crossfire",
+  [] {
+    setupPulsesModule(EXTERNAL_MODULE, MODULE_TYPE_CROSSFIRE, 0);
+  },
+  [](PulsesFrames * frames) {
+    uint8_t frame[CROSSFIRE_FRAME_MAXLEN];
+    uint8_t size = createCrossfireChannelsFrame(frame, channelOutputs);
+    addFrame(frames, frame, size);
+  }
+};
+#endif
+
+#if defined(PXX2) && defined(HARDWARE_EXTERNAL_MODULE)
+static const PulsesProtocol pxx2Protocol = {
+  "pxx2",
+  [] {
+    setupPulsesModule(EXTERNAL_MODULE, MODULE_TYPE_R9M_PXX2, 0);
+  },
+  [](PulsesFrames * frames) {
+    extmodulePulsesData.pxx2.setupFrame(EXTERNAL_MODULE);
+    addFrame(frames, extmodulePulsesData.pxx2.getData(), extmodulePulsesData.pxx2.getSize());
+  }
+};
+#endif
+
+#if defined(MULTIMODULE) && defined(HARDWARE_EXTERNAL_MODULE)
+static const PulsesProtocol multiProtocol = {
+  "multi",
+  [] {
+    setupPulsesModule(EXTERNAL_MODULE, MODULE_TYPE_MULTIMODULE, 1);
+    g_model.moduleData[EXTERNAL_MODULE].setMultiProtocol(MODULE_SUBTYPE_MULTI_FRSKY);
+  },
+  [](PulsesFrames * frames) {
+    setupPulsesMultiExternalModule();
+    addPulsesFrame(frames, extmodulePulsesData.dsm2.pulses, extmodulePulsesData.dsm2.ptr - extmodulePulsesData.dsm2.pulses);
+  }
+};
+#endif
+
+#if defined(DSM2) && defined(HARDWARE_EXTERNAL_MODULE)
+static const PulsesProtocol dsm2Protocol = {
+  "dsmx",
+  [] {
+    setupPulsesModule(EXTERNAL_MODULE, MODULE_TYPE_DSM2, 0);
+    g_model.moduleData[EXTERNAL_MODULE].rfProtocol = DSM2_PROTO_DSMX;
+    moduleState[EXTERNAL_MODULE].protocol = PROTOCOL_CHANNELS_DSM2_DSMX;
+  },
+  [](PulsesFrames * frames) {
+    setupPulsesDSM2();
+    addPulsesFrame(frames, extmodulePulsesData.dsm2.pulses, extmodulePulsesData.dsm2.ptr - extmodulePulsesData.dsm2.pulses);
+  }
+};
+#endif
+
+#if defined(SBUS) && defined(HARDWARE_EXTERNAL_MODULE)
+static const PulsesProtocol sbusProtocol = {
+  "sbus",
+  [] {
+    setupPulsesModule(EXTERNAL_MODULE, MODULE_TYPE_SBUS, 0);
+  },
+  [](PulsesFrames * frames) {
+    setupPulsesSbus();
+    addPulsesFrame(frames, extmodulePulsesData.dsm2.pulses, extmodulePulsesData.dsm2.ptr - extmodulePulsesData.dsm2.pulses);
+  }
+};
+#endif
+
+// in SIMU the serial version doesn't keep the bytes
+#if defined(AFHDS3) && !(defined(EXTMODULE_USART) && defined(EXTMODULE_TX_INVERT_GPIO))
+static void afhds3Response(uint8_t command, uint8_t value)
+{
+  uint8_t frame[] = { afhds3::START, 0x13, 0x00, afhds3::RESPONSE_DATA, command, value, 0x00, afhds3::END };
+  uint8_t crc = 0;
+  for (uint8_t i = 1; i < sizeof(frame) - 2; i++) {
+    crc += frame[i];
+  }
+  frame[sizeof(frame) - 2] = crc ^ 0xFF;
+
+  uint8_t rxBuffer[TELEMETRY_RX_PACKET_SIZE];
+  uint8_t rxBufferCount = 0;
+  for (uint8_t byte: frame) {
+    afhds3::processTelemetryData(EXTERNAL_MODULE, byte, rxBuffer, rxBufferCount, sizeof(rxBuffer));
+  }
+}
+
+static const PulsesProtocol afhds3Protocol = {
+  "afhds3",
+  [] {
+    setupPulsesModule(EXTERNAL_MODULE, MODULE_TYPE_FLYSKY, FLYSKY_SUBTYPE_AFHDS3);
+    memclear(&extmodulePulsesData.afhds3, sizeof(extmodulePulsesData.afhds3));
+    extmodulePulsesData.afhds3.init(EXTERNAL_MODULE);
+    // module ready request, then one way mode (channels frames only)
+    extmodulePulsesData.afhds3.setupFrame();
+    afhds3Response(afhds3::MODULE_STATE, afhds3::STATE_SYNC_RUNNING);
+  },
+  [](PulsesFrames * frames) {
+    extmodulePulsesData.afhds3.setupFrame();
+    addPulsesFrame(frames, extmodulePulsesData.afhds3.getData(), extmodulePulsesData.afhds3.getSize());
+  }
+};
+#endif
+
+class PulsesTest : public OpenTxTest {};
+class PulsesBench : public OpenTxTest {};
+
+#define PULSES_PROTOCOL_TESTS(test, protocol) \
+  TEST_F(PulsesTest, test) { checkProtocol(protocol); } \
+  TEST_F(PulsesBench, DISABLED_##test) { benchProtocol(protocol); }
+
+#if defined(CROSSFIRE)
+PULSES_PROTOCOL_TESTS(Crossfire, crossfireProtocol)
+#endif
+
+#if defined(PXX2) && defined(HARDWARE_EXTERNAL_MODULE)
+PULSES_PROTOCOL_TESTS(Pxx2, pxx2Protocol)
+#endif
+
+#if defined(MULTIMODULE) && defined(HARDWARE_EXTERNAL_MODULE)
+PULSES_PROTOCOL_TESTS(Multi, multiProtocol)
+#endif
+
+#if defined(DSM2) && defined(HARDWARE_EXTERNAL_MODULE)
+PULSES_PROTOCOL_TESTS(Dsmx, dsm2Protocol)
+#endif
+
+#if defined(SBUS) && defined(HARDWARE_EXTERNAL_MODULE)
+PULSES_PROTOCOL_TESTS(Sbus, sbusProtocol)
+#endif
+
+#if defined(AFHDS3) && !(defined(EXTMODULE_USART) && defined(EXTMODULE_TX_INVERT_GPIO))
+PULSES_PROTOCOL_TESTS(Afhds3, afhds3Protocol)
+#endif
@@ -71,7 +71,7 @@ static lua_Number LoadNumber(LoadState* S)
 
 static TString* Load_String(LoadState* S)
 {
- size_t size;
+ LUAC_SIZE_T size;
  LoadVar(S,size);
  if (size==0)
   return NULL;
@@ -250,7 +250,7 @@ void luaU_header (lu_byte* h)
  *h++=cast_byte(FORMAT);
  *h++=cast_byte(*(char*)&x);			/* endianness */
  *h++=cast_byte(sizeof(int));
- *h++=cast_byte(sizeof(size_t));
+ *h++=cast_byte(sizeof(LUAC_SIZE_T));
  *h++=cast_byte(sizeof(Instruction));
  *h++=cast_byte(sizeof(lua_Number));
  *h++=cast_byte(((lua_Number)0.5)==0);		/* is lua_Number integral? */
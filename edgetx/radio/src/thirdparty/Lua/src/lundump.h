@@ -19,6 +19,12 @@ LUAI_FUNC void luaU_header (lu_byte* h);
 /* dump one chunk; from ldump.c */
 LUAI_FUNC int luaU_dump (lua_State* L, const Proto* f, lua_Writer w, void* data, int strip);
 
+/* type of the string sizes in precompiled chunks, may be set to the
+   size_t of the radio when precompiling scripts on a host */
+#if !defined(LUAC_SIZE_T)
+#define LUAC_SIZE_T		size_t
+#endif
+
 /* data to catch conversion errors */
 #define LUAC_TAIL		"\x19\x93\r\n\x1a\n"
 
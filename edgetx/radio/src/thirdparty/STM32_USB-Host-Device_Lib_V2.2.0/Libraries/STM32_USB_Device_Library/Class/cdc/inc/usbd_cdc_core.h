@@ -118,6 +118,7 @@ CDC_IF_Prop_TypeDef;
   */ 
 
 extern const USBD_Class_cb_TypeDef  USBD_CDC_cb;   // modified my OpenTX
+void usbd_cdc_ResumeRx (void *pdev);                // modified by OpenTX
 /**
   * @}
   */ 
@@ -692,7 +692,11 @@ uint8_t  usbd_cdc_DataOut (void *pdev, uint8_t epnum)
   
   /* USB data will be immediately processed, this allow next USB traffic being 
      NAKed till the end of the application Xfer */
-  APP_FOPS.pIf_DataRx(USB_Rx_Buffer, USB_Rx_Cnt);
+  if (APP_FOPS.pIf_DataRx(USB_Rx_Buffer, USB_Rx_Cnt) != USBD_OK)   // modified by OpenTX
+  {
+    /* No room for another packet: keep NAKing until usbd_cdc_ResumeRx() */
+    return USBD_OK;
+  }
   
   /* Prepare Out endpoint to receive next packet */
   DCD_EP_PrepareRx(pdev,
@@ -703,6 +707,21 @@ uint8_t  usbd_cdc_DataOut (void *pdev, uint8_t epnum)
   return USBD_OK;
 }
 
+/**
+  * @brief  usbd_cdc_ResumeRx
+  *         Prepare Out endpoint to receive next packet after pIf_DataRx()
+  *         refused to receive more data
+  * @param  pdev: device instance
+  * @retval None
+  */
+void usbd_cdc_ResumeRx (void *pdev)   // modified by OpenTX
+{
+  DCD_EP_PrepareRx(pdev,
+                   CDC_OUT_EP,
+                   (uint8_t*)(USB_Rx_Buffer),
+                   CDC_DATA_OUT_PACKET_SIZE);
+}
+
 /**
   * @brief  usbd_audio_SOF
   *         Start Of Frame event management
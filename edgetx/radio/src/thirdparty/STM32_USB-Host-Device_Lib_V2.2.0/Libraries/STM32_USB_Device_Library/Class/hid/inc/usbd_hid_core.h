@@ -105,6 +105,9 @@ uint8_t USBD_HID_SendReport (USB_OTG_CORE_HANDLE  *pdev,
 
 uint32_t USBD_HID_GetPollingInterval (USB_OTG_CORE_HANDLE *pdev);
 
+void USBD_HID_SetReportDesc (const uint8_t *desc, uint16_t len, uint16_t inPacketSize);	// modified by OpenTX
+void USBD_HID_SetSOFCallback (void (*cb)(void));	// modified by OpenTX
+
 /**
   * @}
   */ 
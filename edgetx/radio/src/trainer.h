@@ -60,6 +60,7 @@ inline void captureTrainerPulses(uint16_t capture)
     if (channelNumber >= 0 && channelNumber < MAX_TRAINER_CHANNELS) {
       if (val > 800 && val < 2200) {
         ppmInputValidityTimer = PPM_IN_VALID_TIMEOUT;
+        LATENCY_PROBE_INPUT();
         ppmInput[channelNumber++] =
           // +-500 != 512, but close enough.
           (int16_t)(val - 1500) * (g_eeGeneral.PPM_Multiplier+10) / 10;
@@ -219,11 +219,14 @@ const char STR_MOVESTICKSPOTS[] = TR_MOVESTICKSPOTS;
 const char STR_TX[] = TR_TXnRX;
 const char STR_NODATA[] = TR_NODATA;
 const char STR_US[] = TR_US;
+const char STR_OUTPUT_AGE[] = TR_OUTPUT_AGE;
 const char STR_HZ[]  = TR_HZ;
 const char STR_TMIXMAXMS[] = TR_TMIXMAXMS;
 const char STR_FREE_STACK[] = TR_FREE_STACK;
 const char STR_INT_GPS_LABEL[]  = TR_INT_GPS_LABEL;
 const char STR_HEARTBEAT_LABEL[]  = TR_HEARTBEAT_LABEL;
+const char STR_BITMAP_CACHE_LABEL[] = TR_BITMAP_CACHE_LABEL;
+const char STR_TEXT_CACHE_LABEL[] = TR_TEXT_CACHE_LABEL;
 const char STR_LUA_SCRIPTS_LABEL[]  = TR_LUA_SCRIPTS_LABEL;
 const char STR_FREE_MEM_LABEL[]  = TR_FREE_MEM_LABEL;
 const char STR_TIMER_LABEL[]  = TR_TIMER_LABEL;
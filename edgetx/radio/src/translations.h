@@ -373,11 +373,14 @@ extern const char STR_TX[];
 #define STR_RX (STR_TX+OFS_RX)
 extern const char STR_NODATA[];
 extern const char STR_US[];
+extern const char STR_OUTPUT_AGE[];
 extern const char STR_HZ[];
 extern const char STR_TMIXMAXMS[];
 extern const char STR_FREE_STACK[];
 extern const char STR_INT_GPS_LABEL[];
 extern const char STR_HEARTBEAT_LABEL[];
+extern const char STR_BITMAP_CACHE_LABEL[];
+extern const char STR_TEXT_CACHE_LABEL[];
 extern const char STR_LUA_SCRIPTS_LABEL[];
 extern const char STR_FREE_MEM_LABEL[];
 extern const char STR_TIMER_LABEL[];
@@ -0,0 +1,168 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""
+    This script decodes the binary event trace stream of a firmware built
+    with EVENT_TRACE=ON (see radio/src/event_trace.h) and produces a Chrome
+    trace (JSON), which can be opened with https://ui.perfetto.dev or
+    chrome://tracing
+
+    Usage:
+
+        (radio CLI) eventtrace usb
+        cat /dev/ttyACM0 > trace.bin
+        ./event_trace2json.py trace.bin > trace.json
+"""
+
+from __future__ import division, print_function
+
+import json
+import struct
+import sys
+
+SYNC = b"\xA5\x5A"
+RECORD_SIZE = 8
+PACKET_RECORDS = 32
+
+TYPE_TICK = 1
+TYPE_TASK_NAME = 2
+TYPE_TASK_SWITCH = 3
+TYPE_ISR_ENTER = 4
+TYPE_ISR_EXIT = 5
+TYPE_BEGIN = 6
+TYPE_END = 7
+
+# same order as EventTraceIsr
+ISR_NAMES = [
+    "Internal module",
+    "External module",
+    "Telemetry",
+    "AUX serial",
+    "Trainer",
+    "USB",
+    "SDIO",
+    "Audio",
+]
+
+# same order as EventTraceSection
+SECTION_NAMES = [
+    "Mixer",
+    "Telemetry",
+    "perMain",
+    "Lua",
+    "SD read",
+    "SD write",
+]
+
+PID_TASKS = 1
+PID_INTERRUPTS = 2
+PID_CPU = 3
+
+TIMER_WRAP = 0x10000       # 16 bits at 2MHz
+TIMER_TICKS_PER_MS = 2000  # RTOS tick = 1ms
+
+
+def packets(data):
+    """Yields (dropped, records) for each packet, text in between is skipped"""
+    index = 0
+    while True:
+        index = data.find(SYNC, index)
+        if index < 0 or index + 4 > len(data):
+            return
+        count = data[index + 2]
+        dropped = data[index + 3]
+        end = index + 4 + count * RECORD_SIZE
+        if count == 0 or count > PACKET_RECORDS or end > len(data):
+            index += 1
+            continue
+        records = [struct.unpack_from("<HBBI", data, index + 4 + i * RECORD_SIZE) for i in range(count)]
+        yield dropped, records
+        index = end
+
+
+def name(names, index):
+    return names[index] if index < len(names) else "#%d" % index
+
+
+def main():
+    if len(sys.argv) > 1:
+        data = bytearray(open(sys.argv[1], "rb").read())
+    else:
+        data = bytearray(sys.stdin.buffer.read() if hasattr(sys.stdin, "buffer") else sys.stdin.read())
+
+    events = []
+    taskNames = {}
+    currentTask = None
+    taskStart = 0
+    time = 0   # in 2MHz ticks
+    lastRaw = None
+    tickOffset = None
+
+    def timestamp():
+        return time / 2.0
+
+    def taskResidency():
+        # complete events on their own track, so that they don't interfere
+        # with the nesting of the sections on the task tracks
+        events.append({"name": taskNames.get(currentTask, "task %d" % currentTask), "ph": "X", "ts": taskStart / 2.0,
+                       "dur": (time - taskStart) / 2.0, "pid": PID_CPU, "tid": 0})
+
+    for dropped, records in packets(data):
+        if dropped:
+            events.append({"name": "%d records dropped" % dropped, "ph": "i", "s": "g", "ts": timestamp(), "pid": PID_TASKS, "tid": 0})
+
+        for raw, type, id, arg in records:
+            if type == TYPE_TASK_NAME:
+                # the time field is the offset in the name
+                chars = struct.pack("<I", arg).split(b"\0")[0].decode("ascii", "replace")
+                name_ = taskNames.get(id, "")
+                taskNames[id] = name_[:raw] + chars
+                continue
+
+            if lastRaw is not None:
+                time += (raw - lastRaw) & 0xFFFF
+            lastRaw = raw
+
+            if type == TYPE_TICK:
+                # the 16 bits timer wraps every 32ms: after dropped records
+                # the unwrapped time is resynchronized on the RTOS ticks
+                if tickOffset is None:
+                    tickOffset = time - arg * TIMER_TICKS_PER_MS
+                else:
+                    expected = arg * TIMER_TICKS_PER_MS + tickOffset
+                    wraps = int(round((expected - time) / TIMER_WRAP))
+                    time += wraps * TIMER_WRAP
+
+            if type == TYPE_TASK_SWITCH:
+                if currentTask is not None:
+                    taskResidency()
+                currentTask = id
+                taskStart = time
+            elif type == TYPE_ISR_ENTER:
+                events.append({"name": name(ISR_NAMES, id), "ph": "B", "ts": timestamp(), "pid": PID_INTERRUPTS, "tid": id})
+            elif type == TYPE_ISR_EXIT:
+                events.append({"ph": "E", "ts": timestamp(), "pid": PID_INTERRUPTS, "tid": id})
+            elif type == TYPE_BEGIN:
+                events.append({"name": name(SECTION_NAMES, id), "ph": "B", "ts": timestamp(), "pid": PID_TASKS, "tid": currentTask or 0, "args": {"arg": arg}})
+            elif type == TYPE_END:
+                events.append({"ph": "E", "ts": timestamp(), "pid": PID_TASKS, "tid": currentTask or 0})
+            elif type == TYPE_TICK:
+                events.append({"name": "tick", "ph": "i", "s": "p", "ts": timestamp(), "pid": PID_TASKS, "tid": 0, "args": {"ticks": arg}})
+
+    events.append({"name": "process_name", "ph": "M", "pid": PID_TASKS, "args": {"name": "Tasks"}})
+    if currentTask is not None:
+        taskResidency()
+
+    events.append({"name": "process_name", "ph": "M", "pid": PID_INTERRUPTS, "args": {"name": "Interrupts"}})
+    events.append({"name": "process_name", "ph": "M", "pid": PID_CPU, "args": {"name": "CPU"}})
+    events.append({"name": "thread_name", "ph": "M", "pid": PID_CPU, "tid": 0, "args": {"name": "Running task"}})
+    for task, taskName in taskNames.items():
+        events.append({"name": "thread_name", "ph": "M", "pid": PID_TASKS, "tid": task, "args": {"name": taskName}})
+    for isr, isrName in enumerate(ISR_NAMES):
+        events.append({"name": "thread_name", "ph": "M", "pid": PID_INTERRUPTS, "tid": isr, "args": {"name": isrName}})
+
+    json.dump({"traceEvents": events, "displayTimeUnit": "ms"}, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()